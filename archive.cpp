@@ -1,57 +1,1533 @@
 #include "include/archive.h"
+#include "include/bulk_writer.h"
+#include "include/crc32.h"
+#include "include/file_sink.h"
+#include <zlib.h>
+#ifdef PURR_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
 #include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace fs = std::filesystem;
 
-bool extractArchive(const std::string& zipPath, const std::string& extractDir) {
-    // Verify zip file exists
-    if (!fs::exists(zipPath)) {
-        std::cerr << "Archive does not exist: " << zipPath << std::endl;
+// Zip record signatures and flags (APPNOTE 4.3)
+constexpr std::uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+constexpr std::uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+constexpr std::uint32_t END_OF_CENTRAL_SIGNATURE = 0x06054b50;
+constexpr std::uint32_t DATA_DESCRIPTOR_SIGNATURE = 0x08074b50;
+constexpr std::uint32_t ZIP64_END_OF_CENTRAL_SIGNATURE = 0x06064b50;
+constexpr std::uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+constexpr std::uint16_t ZIP64_EXTRA_ID = 0x0001;
+constexpr std::uint16_t FLAG_ENCRYPTED = 0x0001;
+constexpr std::uint16_t FLAG_DATA_DESCRIPTOR = 0x0008;
+constexpr std::uint16_t METHOD_STORED = 0;
+constexpr std::uint16_t METHOD_DEFLATE = 8;
+constexpr size_t LOCAL_HEADER_SIZE = 30;
+constexpr size_t CENTRAL_HEADER_SIZE = 46;
+constexpr size_t END_OF_CENTRAL_SIZE = 22;
+constexpr size_t ZIP64_LOCATOR_SIZE = 20;
+constexpr size_t ZIP64_END_OF_CENTRAL_SIZE = 56;
+constexpr size_t MAX_COMMENT_SIZE = 0xFFFF;
+constexpr size_t INFLATE_CHUNK_SIZE = 256 * 1024;
+constexpr std::uint32_t GZIP_MAGIC = 0x8b1f;
+constexpr std::uint32_t ZSTD_MAGIC = 0xFD2FB528;
+constexpr size_t TAR_BLOCK_SIZE = 512;
+constexpr std::uint64_t MAX_TAR_META_SIZE = 1024 * 1024;  // Long names and pax headers
+
+static std::uint16_t readLE16(const char* p) {
+    const auto* b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<std::uint16_t>(b[0] | (b[1] << 8));
+}
+
+static std::uint32_t readLE32(const char* p) {
+    return readLE16(p) | (static_cast<std::uint32_t>(readLE16(p + 2)) << 16);
+}
+
+static std::uint64_t readLE64(const char* p) {
+    return readLE32(p) | (static_cast<std::uint64_t>(readLE32(p + 4)) << 32);
+}
+
+// Entry name to a path below the extraction root; rejects absolute paths and ".." (zip slip)
+static bool safeRelativePath(const std::string& name, fs::path& out) {
+    std::string normalized = name;
+    std::replace(normalized.begin(), normalized.end(), '\\', '/');
+    if (normalized.empty() || normalized.front() == '/' || normalized.find(':') != std::string::npos) {
         return false;
     }
 
-    // Verify zip file is not empty
-    try {
-        if (fs::file_size(zipPath) == 0) {
-            std::cerr << "Archive is empty: " << zipPath << std::endl;
+    fs::path relative;
+    size_t begin = 0;
+    while (begin <= normalized.size()) {
+        size_t end = normalized.find('/', begin);
+        if (end == std::string::npos) end = normalized.size();
+        const std::string component = normalized.substr(begin, end - begin);
+        if (component == "..") return false;
+        if (!component.empty() && component != ".") {
+            relative /= fs::path(std::u8string(component.begin(), component.end()));
+        }
+        begin = end + 1;
+    }
+    out = relative;
+    return !relative.empty();
+}
+
+// Open target for new contents without touching the old file's data: it may be a hardlink into
+// the artifact store or into the pack tree an update was staged from, so it is unlinked first
+static bool openReplacing(FileSink& sink, const fs::path& target) {
+    std::error_code ec;
+    fs::remove(target, ec);
+    return sink.open(target.string(), FileSink::Mode::Truncate);
+}
+
+// Read-only view of a whole file. Entries are inflated straight from the mapping, so workers
+// share one copy of the archive in the page cache and need no read buffers or seeks.
+class MappedFile {
+private:
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+    const char* view = nullptr;
+    std::uint64_t length = 0;
+
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path, std::string& error) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER size;
+        if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size)) {
+            error = "Archive does not exist: " + path;
             return false;
         }
-    } catch (const fs::filesystem_error& e) {
-        std::cerr << "Failed to check archive size: " << e.what() << std::endl;
+        length = static_cast<std::uint64_t>(size.QuadPart);
+        if (length == 0) {
+            error = "Archive is empty: " + path;
+            return false;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            if (fd >= 0) ::close(fd);
+            error = "Archive does not exist: " + path;
+            return false;
+        }
+        length = static_cast<std::uint64_t>(st.st_size);
+        if (length == 0) {
+            ::close(fd);
+            error = "Archive is empty: " + path;
+            return false;
+        }
+        void* p = mmap(nullptr, static_cast<size_t>(length), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // The mapping keeps its own reference
+        if (p != MAP_FAILED) view = static_cast<const char*>(p);
+#endif
+        if (!view) {
+            error = "Failed to map " + path;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (view) munmap(const_cast<char*>(view), static_cast<size_t>(length));
+#endif
+        view = nullptr;
+        length = 0;
+    }
+
+    std::uint64_t size() const { return length; }
+
+    // Bytes [offset, offset + count), or nullptr when that range is not inside the file
+    const char* at(std::uint64_t offset, std::uint64_t count) const {
+        if (!view || offset > length || count > length - offset) return nullptr;
+        return view + offset;
+    }
+};
+
+// Where an entry's data lives; the parts of the central header that ZipEntryInfo leaves out
+struct ZipEntryLocation {
+    std::uint16_t madeBy = 0;
+    std::uint16_t flags = 0;
+    std::uint64_t localHeaderOffset = 0;
+    std::uint32_t externalAttributes = 0;
+    fs::path relative;  // Validated path below the extraction root
+};
+
+struct ZipReader::State {
+    MappedFile file;
+    std::vector<ZipEntryInfo> entries;
+    std::vector<ZipEntryLocation> locations;  // Parallel to entries
+    std::string error;
+    size_t files = 0;
+    std::uint64_t bytes = 0;
+    size_t skipped = 0;
+
+    bool fail(const std::string& message) {
+        error = message;
         return false;
     }
 
-    // Create extraction directory if it doesn't exist
-    try {
-        fs::create_directories(extractDir);
-    } catch (const fs::filesystem_error& e) {
-        std::cerr << "Failed to create extraction directory: " << e.what() << std::endl;
+    // Extract accepted entries across the worker pool. Files under `reuse` whose size and CRC-32
+    // already match are hard-linked into root instead of written.
+    bool extractEntries(const fs::path& root, const EntryFilter& filter, size_t maxThreads, const fs::path& reuse);
+
+    // Find the end of central directory record (zip64 if present) and index every central header
+    bool readCentralDirectory() {
+        const std::uint64_t archiveSize = file.size();
+        if (archiveSize < END_OF_CENTRAL_SIZE) return fail("Not a zip archive (too small)");
+
+        // The record sits at the very end, followed only by a comment of at most 64 KiB
+        const std::uint64_t tailSize =
+            std::min<std::uint64_t>(archiveSize, END_OF_CENTRAL_SIZE + MAX_COMMENT_SIZE + ZIP64_LOCATOR_SIZE);
+        const char* tail = file.at(archiveSize - tailSize, tailSize);
+
+        size_t eocd = static_cast<size_t>(tailSize) - END_OF_CENTRAL_SIZE;
+        while (readLE32(tail + eocd) != END_OF_CENTRAL_SIGNATURE) {
+            if (eocd == 0) return fail("Not a zip archive (no end of central directory)");
+            --eocd;
+        }
+
+        const char* record = tail + eocd;
+        std::uint64_t entryCount = readLE16(record + 10);
+        std::uint64_t directorySize = readLE32(record + 12);
+        std::uint64_t directoryOffset = readLE32(record + 16);
+
+        // Zip64: the locator right before the record points at the 64-bit version of it
+        if (eocd >= ZIP64_LOCATOR_SIZE && readLE32(record - ZIP64_LOCATOR_SIZE) == ZIP64_LOCATOR_SIGNATURE) {
+            const char* zip64 = file.at(readLE64(record - ZIP64_LOCATOR_SIZE + 8), ZIP64_END_OF_CENTRAL_SIZE);
+            if (!zip64 || readLE32(zip64) != ZIP64_END_OF_CENTRAL_SIGNATURE) {
+                return fail("Corrupt zip64 end of central directory");
+            }
+            entryCount = readLE64(zip64 + 32);
+            directorySize = readLE64(zip64 + 40);
+            directoryOffset = readLE64(zip64 + 48);
+        }
+
+        const char* directory = file.at(directoryOffset, directorySize);
+        if (!directory) return fail("Central directory lies outside the archive");
+
+        entries.clear();
+        locations.clear();
+        const size_t expected = static_cast<size_t>(std::min<std::uint64_t>(entryCount, directorySize / CENTRAL_HEADER_SIZE));
+        entries.reserve(expected);
+        locations.reserve(expected);
+
+        std::uint64_t offset = 0;
+        for (std::uint64_t i = 0; i < entryCount; ++i) {
+            const char* header = directory + offset;
+            if (offset + CENTRAL_HEADER_SIZE > directorySize || readLE32(header) != CENTRAL_HEADER_SIGNATURE) {
+                return fail("Corrupt central directory");
+            }
+            const size_t nameLength = readLE16(header + 28);
+            const size_t extraLength = readLE16(header + 30);
+            const size_t commentLength = readLE16(header + 32);
+            if (offset + CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength > directorySize) {
+                return fail("Corrupt central directory");
+            }
+
+            ZipEntryInfo info;
+            ZipEntryLocation location;
+            location.madeBy = readLE16(header + 4);
+            location.flags = readLE16(header + 8);
+            info.method = readLE16(header + 10);
+            info.crc = readLE32(header + 16);
+            info.compressedSize = readLE32(header + 20);
+            info.uncompressedSize = readLE32(header + 24);
+            location.externalAttributes = readLE32(header + 38);
+            location.localHeaderOffset = readLE32(header + 42);
+            info.name.assign(header + CENTRAL_HEADER_SIZE, nameLength);
+            info.isDirectory = !info.name.empty() && (info.name.back() == '/' || info.name.back() == '\\');
+
+            // Zip64 extra field: 64-bit values for exactly the fields that hold 0xFFFFFFFF, in this order
+            const char* extra = header + CENTRAL_HEADER_SIZE + nameLength;
+            for (size_t field = 0; field + 4 <= extraLength;) {
+                const std::uint16_t id = readLE16(extra + field);
+                const size_t size = std::min<size_t>(readLE16(extra + field + 2), extraLength - field - 4);
+                if (id == ZIP64_EXTRA_ID) {
+                    const char* value = extra + field + 4;
+                    size_t used = 0;
+                    for (std::uint64_t* target : {&info.uncompressedSize, &info.compressedSize, &location.localHeaderOffset}) {
+                        if (*target != 0xFFFFFFFFu || used + 8 > size) continue;
+                        *target = readLE64(value + used);
+                        used += 8;
+                    }
+                }
+                field += 4 + size;
+            }
+
+            if (!safeRelativePath(info.name, location.relative)) return fail("Unsafe path in archive: " + info.name);
+            entries.push_back(std::move(info));
+            locations.push_back(std::move(location));
+            offset += CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+        }
+        return true;
+    }
+};
+
+// Per-thread extraction state: output file and zlib inflater. Input comes from the shared mapping.
+// Small files are written whole through a BulkFileWriter instead of one FileSink open each.
+class ZipWorker {
+private:
+    const MappedFile& file;
+    FileSink sink;
+    BulkFileWriter writer;
+    std::vector<char> smallFile;
+    bool buffering = false;
+    std::vector<char> output;
+    z_stream inflater = {};
+    bool inflaterReady = false;
+
+    bool fail(const std::string& message) {
+        error = message;
+        sink.close();
+        return false;
+    }
+
+    bool writeOutput(const char* data, size_t length, std::uint32_t& crc, std::uint64_t& produced) {
+        crc = crc32Update(crc, data, length);
+        produced += length;
+        if (buffering) {
+            smallFile.insert(smallFile.end(), data, data + length);
+            return true;
+        }
+        return length == 0 || sink.write(data, length) == length;
+    }
+
+public:
+    std::string error;
+
+    // One helper thread if the writer falls back to a pool: the workers are a pool already
+    explicit ZipWorker(const MappedFile& archive)
+        : file(archive), sink(INFLATE_CHUNK_SIZE), writer(1), output(INFLATE_CHUNK_SIZE) {
+        inflaterReady = inflateInit2(&inflater, -MAX_WBITS) == Z_OK;  // Raw deflate, no zlib header
+    }
+
+    ~ZipWorker() {
+        if (inflaterReady) inflateEnd(&inflater);
+    }
+
+    ZipWorker(const ZipWorker&) = delete;
+    ZipWorker& operator=(const ZipWorker&) = delete;
+
+    // The file already holds this entry: same size and CRC-32. Reading is far cheaper than rewriting.
+    bool matches(const ZipEntryInfo& entry, const fs::path& target) {
+        std::error_code ec;
+        if (!fs::is_regular_file(target, ec) || fs::file_size(target, ec) != entry.uncompressedSize || ec) return false;
+        if (entry.uncompressedSize == 0) return entry.crc == 0;
+
+        MappedFile existing;
+        std::string ignored;
+        if (!existing.open(target.string(), ignored)) return false;
+        return crc32Update(0, existing.at(0, existing.size()), static_cast<size_t>(existing.size())) == entry.crc;
+    }
+
+    // Put an identical existing file at target without writing its data again
+    bool reuse(const fs::path& existing, const fs::path& target) {
+        std::error_code ec;
+        fs::remove(target, ec);
+        fs::create_hard_link(existing, target, ec);
+        if (!ec) return true;
+        // Other volume or a filesystem without links (FAT): a plain copy still skips the inflate
+        fs::copy_file(existing, target, fs::copy_options::overwrite_existing, ec);
+        return !ec;
+    }
+
+    bool extract(const ZipEntryInfo& entry, const ZipEntryLocation& location, const fs::path& target) {
+        if (location.flags & FLAG_ENCRYPTED) return fail("Encrypted entry: " + entry.name);
+        if (entry.method != METHOD_STORED && entry.method != METHOD_DEFLATE) {
+            return fail("Unsupported compression method " + std::to_string(entry.method) + ": " + entry.name);
+        }
+        if (entry.method == METHOD_DEFLATE && !inflaterReady) return fail("Failed to initialize zlib");
+
+        // Name and extra field lengths in the local header may differ from the central copy
+        const char* header = file.at(location.localHeaderOffset, LOCAL_HEADER_SIZE);
+        if (!header || readLE32(header) != LOCAL_HEADER_SIGNATURE) return fail("Corrupt local header: " + entry.name);
+        const char* data = file.at(location.localHeaderOffset + LOCAL_HEADER_SIZE + readLE16(header + 26) +
+                                   readLE16(header + 28), entry.compressedSize);
+        if (!data) return fail("Truncated entry: " + entry.name);
+
+#ifndef _WIN32
+        // Keep the executable bit of archives made on Unix (JDK bin/, launch scripts)
+        const mode_t mode = static_cast<mode_t>(location.externalAttributes >> 16);
+        const bool executable = (location.madeBy >> 8) == 3 && (mode & 0111);
+#else
+        const std::uint32_t mode = 0;
+        const bool executable = false;
+#endif
+        std::uint64_t produced = 0;
+        std::uint32_t crc = 0;
+
+        buffering = entry.uncompressedSize <= BulkFileWriter::SMALL_FILE_LIMIT;
+        if (buffering && entry.method == METHOD_STORED) {
+            // Written straight from the mapping, which outlives the writer
+            if (entry.compressedSize != entry.uncompressedSize) return fail("Size mismatch: " + entry.name);
+            const size_t size = static_cast<size_t>(entry.uncompressedSize);
+            if (crc32Update(0, data, size) != entry.crc) return fail("CRC mismatch: " + entry.name);
+            if (!writer.write(target.string(), data, size, executable ? (mode & 0777) : 0644)) return fail(writer.error());
+            return true;
+        }
+        if (buffering) {
+            smallFile.clear();
+            smallFile.reserve(static_cast<size_t>(entry.uncompressedSize));
+        } else {
+            if (!openReplacing(sink, target)) return fail("Failed to create " + target.string());
+            if (entry.uncompressedSize > 0) sink.preallocate(entry.uncompressedSize);
+        }
+
+        if (entry.method == METHOD_STORED) {
+            for (std::uint64_t done = 0; done < entry.compressedSize;) {
+                const size_t count = static_cast<size_t>(std::min<std::uint64_t>(entry.compressedSize - done, INFLATE_CHUNK_SIZE));
+                if (!writeOutput(data + done, count, crc, produced)) return fail("Failed to write " + target.string());
+                done += count;
+            }
+        } else {
+            inflateReset(&inflater);
+            std::uint64_t remaining = entry.compressedSize;
+            inflater.avail_in = 0;
+            for (;;) {
+                // avail_in is 32-bit; entries above 4 GiB are fed in pieces
+                if (inflater.avail_in == 0 && remaining > 0) {
+                    const uInt count = static_cast<uInt>(std::min<std::uint64_t>(remaining, 1u << 30));
+                    inflater.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data + (entry.compressedSize - remaining)));
+                    inflater.avail_in = count;
+                    remaining -= count;
+                }
+                inflater.next_out = reinterpret_cast<Bytef*>(output.data());
+                inflater.avail_out = static_cast<uInt>(output.size());
+                const int rc = inflate(&inflater, Z_NO_FLUSH);
+                if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) {
+                    return fail("Corrupt deflate data in " + entry.name);
+                }
+                const size_t have = output.size() - inflater.avail_out;
+                if (!writeOutput(output.data(), have, crc, produced)) return fail("Failed to write " + target.string());
+                if (rc == Z_STREAM_END) break;
+                if (rc == Z_BUF_ERROR && have == 0 && remaining == 0) return fail("Truncated deflate stream: " + entry.name);
+            }
+        }
+
+        if (crc != entry.crc) return fail("CRC mismatch: " + entry.name);
+        if (produced != entry.uncompressedSize) return fail("Size mismatch: " + entry.name);
+        if (buffering) {
+            // Only verified data reaches the disk
+            const std::uint32_t fileMode = executable ? (mode & 0777) : 0644;
+            if (!writer.write(target.string(), std::move(smallFile), fileMode)) return fail(writer.error());
+            smallFile = std::vector<char>();
+            return true;
+        }
+        if (!sink.close()) return fail("Failed to write " + target.string());
+
+        if (executable) {
+            std::error_code ec;
+            fs::permissions(target, static_cast<fs::perms>(mode & 0777), ec);
+        }
+        return true;
+    }
+
+    // Wait for the small files still queued in the writer
+    bool finish() {
+        return writer.flush() || fail(writer.error());
+    }
+};
+
+ZipReader::ZipReader() : state(std::make_unique<State>()) {}
+
+ZipReader::~ZipReader() = default;
+
+bool ZipReader::open(const std::string& zipPath) {
+    state = std::make_unique<State>();
+    if (!state->file.open(zipPath, state->error)) return false;
+    if (!state->readCentralDirectory()) {
+        state->file.close();
         return false;
     }
+    return true;
+}
+
+void ZipReader::close() {
+    state = std::make_unique<State>();
+}
+
+const std::vector<ZipEntryInfo>& ZipReader::entries() const {
+    return state->entries;
+}
+
+bool ZipReader::State::extractEntries(const fs::path& root, const EntryFilter& filter, size_t maxThreads,
+                                      const fs::path& reuse) {
+    files = 0;
+    bytes = 0;
+    skipped = 0;
+    if (file.size() == 0) return fail("No archive open");
+
+    // Directories up front, so workers never race each other creating the same parent
+    std::set<fs::path> directories{root};
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (filter && !filter(entries[i])) continue;
+        const fs::path target = root / locations[i].relative;
+        if (entries[i].isDirectory) {
+            directories.insert(target);
+        } else {
+            directories.insert(target.parent_path());
+            pending.push_back(i);
+        }
+    }
+    for (const auto& directory : directories) {
+        std::error_code ec;
+        fs::create_directories(directory, ec);
+        if (ec) return fail("Failed to create directory " + directory.string() + ": " + ec.message());
+    }
+
+    // Largest entries first, so one big file does not start last and hold up the whole pool
+    std::sort(pending.begin(), pending.end(), [&](size_t a, size_t b) {
+        return entries[a].uncompressedSize > entries[b].uncompressedSize;
+    });
+
+    size_t threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    if (maxThreads > 0) threadCount = std::min(threadCount, maxThreads);
+    threadCount = std::min(threadCount, std::max<size_t>(pending.size(), 1));
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::atomic<size_t> unchanged{0};
+    std::atomic<std::uint64_t> bytesWritten{0};
+    std::mutex errorMutex;
+
+    auto work = [&]() {
+        ZipWorker worker(file);
+        while (!failed) {
+            const size_t index = next++;
+            if (index >= pending.size()) break;
+            const ZipEntryInfo& entry = entries[pending[index]];
+            const ZipEntryLocation& location = locations[pending[index]];
+            const fs::path target = root / location.relative;
+            if (!reuse.empty()) {
+                const fs::path existing = reuse / location.relative;
+                if (worker.matches(entry, existing) && worker.reuse(existing, target)) {
+                    ++unchanged;
+                    continue;
+                }
+            }
+            if (!worker.extract(entry, location, target)) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!failed.exchange(true)) error = worker.error;
+                return;
+            }
+            bytesWritten += entry.uncompressedSize;
+        }
+        if (!worker.finish()) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!failed.exchange(true)) error = worker.error;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threadCount; ++i) pool.emplace_back(work);
+    work();
+    for (auto& thread : pool) thread.join();
+
+    if (failed) return false;
+    skipped = unchanged;
+    files = pending.size() - skipped;
+    bytes = bytesWritten;
+    return true;
+}
+
+bool ZipReader::extract(const std::string& extractDir, const EntryFilter& filter, size_t maxThreads) {
+    return state->extractEntries(fs::path(extractDir), filter, maxThreads, fs::path());
+}
+
+bool ZipReader::stage(const std::string& stagingDir, const std::string& baseDir) {
+    return state->extractEntries(fs::path(stagingDir), nullptr, 0, fs::path(baseDir));
+}
 
-    // Build PowerShell command with better error handling
-    std::string command = "powershell -NoProfile -ExecutionPolicy Bypass -Command \"";
-    command += "try { ";
-    command += "Expand-Archive -LiteralPath '" + zipPath + "' ";
-    command += "-DestinationPath '" + extractDir + "' -Force -ErrorAction Stop; ";
-    command += "exit 0 ";
-    command += "} catch { ";
-    command += "Write-Error $_.Exception.Message; ";
-    command += "exit 1 ";
-    command += "}\"";
+const std::string& ZipReader::error() const {
+    return state->error;
+}
 
+size_t ZipReader::filesExtracted() const {
+    return state->files;
+}
+
+size_t ZipReader::filesSkipped() const {
+    return state->skipped;
+}
+
+std::uint64_t ZipReader::bytesExtracted() const {
+    return state->bytes;
+}
+
+bool extractArchive(const std::string& zipPath, const std::string& extractDir) {
     std::cout << "Extracting archive: " << zipPath << std::endl;
 
-    int result = system(command.c_str());
+    ZipReader reader;
+    if (!reader.open(zipPath) || !reader.extract(extractDir)) {
+        std::cerr << "Extraction failed: " << reader.error() << std::endl;
+        std::cerr << "The archive might be corrupted or incomplete." << std::endl;
+        return false;
+    }
+
+    std::cout << "Extraction completed successfully (" << reader.filesExtracted() << " files, "
+             << (reader.bytesExtracted() / (1024 * 1024)) << " MB)." << std::endl;
+    return true;
+}
+
+struct ZipStreamExtractor::State {
+    enum class Stage { Signature, Header, Data, Descriptor, Done, Failed };
+
+    fs::path root;
+    Stage stage = Stage::Signature;
+    std::string pending;  // Header bytes collected across chunks
+    std::string error;
+    bool unsupported = false;
+    size_t entries = 0;
+    std::uint64_t totalBytes = 0;
+
+    // Entry being extracted
+    std::string name;
+    std::uint16_t flags = 0;
+    std::uint16_t method = 0;
+    bool zip64 = false;
+    bool isDirectory = false;
+    std::uint32_t expectedCrc = 0;
+    std::uint64_t compressedSize = 0;
+    std::uint64_t uncompressedSize = 0;
+    std::uint64_t consumed = 0;  // Compressed bytes read
+    std::uint64_t produced = 0;  // Uncompressed bytes written
+    std::uint32_t crc = 0;
+    FileSink sink;
+    BulkFileWriter writer;
+    std::vector<char> smallFile;  // Whole entry, when it is small and its size known up front
+    bool buffering = false;
+    fs::path target;
+
+    z_stream inflater = {};
+    bool inflaterReady = false;
+    std::vector<char> output;
+
+    explicit State(const std::string& extractDir) : root(extractDir), output(INFLATE_CHUNK_SIZE) {
+        inflaterReady = inflateInit2(&inflater, -MAX_WBITS) == Z_OK;  // Raw deflate, no zlib header
+    }
+
+    ~State() {
+        if (inflaterReady) inflateEnd(&inflater);
+    }
+
+    bool fail(const std::string& message, bool needsSeekableReader = false) {
+        error = message;
+        unsupported = needsSeekableReader;
+        stage = Stage::Failed;
+        sink.close();
+        return false;
+    }
+
+    // Move input into pending until it holds `need` bytes; false means wait for more data
+    bool take(size_t need, const char*& data, size_t& length) {
+        if (pending.size() < need) {
+            const size_t count = std::min(need - pending.size(), length);
+            pending.append(data, count);
+            data += count;
+            length -= count;
+        }
+        return pending.size() >= need;
+    }
+
+    bool writeOutput(const char* data, size_t length) {
+        crc = crc32Update(crc, data, length);
+        produced += length;
+        if (isDirectory || length == 0) return true;
+        if (buffering) {
+            if (smallFile.size() + length > uncompressedSize) return fail("Size mismatch: " + name);
+            smallFile.insert(smallFile.end(), data, data + length);
+            return true;
+        }
+        if (sink.write(data, length) != length) return fail("Failed to write " + sink.getPath());
+        return true;
+    }
+
+    bool beginEntry() {
+        flags = readLE16(pending.data() + 6);
+        method = readLE16(pending.data() + 8);
+        expectedCrc = readLE32(pending.data() + 14);
+        compressedSize = readLE32(pending.data() + 18);
+        uncompressedSize = readLE32(pending.data() + 22);
+        const size_t nameLength = readLE16(pending.data() + 26);
+        const size_t extraLength = readLE16(pending.data() + 28);
+        name = pending.substr(LOCAL_HEADER_SIZE, nameLength);
+
+        // Zip64 extra field: 64-bit sizes replace the 0xFFFFFFFF placeholders, in this order
+        zip64 = false;
+        const char* extra = pending.data() + LOCAL_HEADER_SIZE + nameLength;
+        for (size_t offset = 0; offset + 4 <= extraLength;) {
+            const std::uint16_t id = readLE16(extra + offset);
+            const size_t size = std::min<size_t>(readLE16(extra + offset + 2), extraLength - offset - 4);
+            if (id == ZIP64_EXTRA_ID) {
+                zip64 = true;
+                const char* field = extra + offset + 4;
+                size_t used = 0;
+                if (uncompressedSize == 0xFFFFFFFFu && used + 8 <= size) {
+                    uncompressedSize = readLE64(field + used);
+                    used += 8;
+                }
+                if (compressedSize == 0xFFFFFFFFu && used + 8 <= size) {
+                    compressedSize = readLE64(field + used);
+                }
+            }
+            offset += 4 + size;
+        }
+        pending.clear();
+
+        if (flags & FLAG_ENCRYPTED) return fail("Encrypted entry: " + name, true);
+        if (method != METHOD_STORED && method != METHOD_DEFLATE) {
+            return fail("Unsupported compression method " + std::to_string(method) + ": " + name, true);
+        }
+        // Without a size, the end of stored data can only be found through the central directory
+        if (method == METHOD_STORED && (flags & FLAG_DATA_DESCRIPTOR)) {
+            return fail("Stored entry with a data descriptor: " + name, true);
+        }
+
+        fs::path relative;
+        if (!safeRelativePath(name, relative)) return fail("Unsafe path in archive: " + name);
+
+        isDirectory = name.back() == '/' || name.back() == '\\';
+        consumed = 0;
+        produced = 0;
+        crc = 0;
+        if (method == METHOD_DEFLATE && inflaterReady) inflateReset(&inflater);
+        if (method == METHOD_DEFLATE && !inflaterReady) return fail("Failed to initialize zlib");
+
+        target = root / relative;
+        std::error_code ec;
+        fs::create_directories(isDirectory ? target : target.parent_path(), ec);
+        if (ec) return fail("Failed to create directory for " + name + ": " + ec.message());
+        buffering = !isDirectory && !(flags & FLAG_DATA_DESCRIPTOR) && uncompressedSize <= BulkFileWriter::SMALL_FILE_LIMIT;
+        if (buffering) {
+            smallFile.clear();
+            smallFile.reserve(static_cast<size_t>(uncompressedSize));
+        } else if (!isDirectory) {
+            if (!openReplacing(sink, target)) return fail("Failed to create " + target.string());
+            if (!(flags & FLAG_DATA_DESCRIPTOR) && uncompressedSize > 0) sink.preallocate(uncompressedSize);
+        }
+
+        stage = Stage::Data;
+        if (!(flags & FLAG_DATA_DESCRIPTOR) && compressedSize == 0) return endData();
+        return true;
+    }
+
+    bool processData(const char*& data, size_t& length) {
+        // Sizes from the local header bound the entry; with a descriptor the deflate stream ends itself
+        const bool bounded = !(flags & FLAG_DATA_DESCRIPTOR);
+        const size_t available = bounded
+            ? static_cast<size_t>(std::min<std::uint64_t>(length, compressedSize - consumed))
+            : length;
+
+        if (method == METHOD_STORED) {
+            if (!writeOutput(data, available)) return false;
+            consumed += available;
+            data += available;
+            length -= available;
+            return consumed == compressedSize ? endData() : true;
+        }
+
+        inflater.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        inflater.avail_in = static_cast<uInt>(available);
+        bool streamEnded = false;
+        for (;;) {
+            inflater.next_out = reinterpret_cast<Bytef*>(output.data());
+            inflater.avail_out = static_cast<uInt>(output.size());
+            const int rc = inflate(&inflater, Z_NO_FLUSH);
+            if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) {
+                return fail("Corrupt deflate data in " + name);
+            }
+            const size_t have = output.size() - inflater.avail_out;
+            if (!writeOutput(output.data(), have)) return false;
+            if (rc == Z_STREAM_END) {
+                streamEnded = true;
+                break;
+            }
+            // Input used up and nothing left buffered in zlib: wait for the next chunk
+            if (inflater.avail_out > 0 || (rc == Z_BUF_ERROR && have == 0)) break;
+        }
+
+        const size_t used = available - inflater.avail_in;
+        consumed += used;
+        data += used;
+        length -= used;
+
+        if (streamEnded) {
+            if (bounded && consumed != compressedSize) return fail("Deflate stream shorter than recorded size: " + name);
+            return endData();
+        }
+        if (bounded && consumed == compressedSize) return fail("Truncated deflate stream: " + name);
+        return true;
+    }
+
+    bool endData() {
+        if (flags & FLAG_DATA_DESCRIPTOR) {
+            stage = Stage::Descriptor;
+            return true;
+        }
+        return closeEntry();
+    }
+
+    bool parseDescriptor(const char*& data, size_t& length) {
+        if (!take(4, data, length)) return true;
+        // The descriptor signature is optional, so the first word may already be the CRC
+        const size_t base = readLE32(pending.data()) == DATA_DESCRIPTOR_SIGNATURE ? 4 : 0;
+        if (!take(base + (zip64 ? 20 : 12), data, length)) return true;
+
+        const char* record = pending.data() + base;
+        expectedCrc = readLE32(record);
+        compressedSize = zip64 ? readLE64(record + 4) : readLE32(record + 4);
+        uncompressedSize = zip64 ? readLE64(record + 12) : readLE32(record + 8);
+        pending.clear();
+
+        if (compressedSize != consumed) return fail("Compressed size mismatch: " + name);
+        return closeEntry();
+    }
+
+    bool closeEntry() {
+        if (crc != expectedCrc) return fail("CRC mismatch: " + name);
+        if (produced != uncompressedSize) return fail("Size mismatch: " + name);
+        if (buffering) {
+            if (!writer.write(target.string(), std::move(smallFile))) return fail(writer.error());
+            smallFile = std::vector<char>();
+        } else if (!isDirectory && !sink.close()) {
+            return fail("Failed to write " + sink.getPath());
+        }
+
+        ++entries;
+        totalBytes += produced;
+        stage = Stage::Signature;
+        return true;
+    }
+};
+
+ZipStreamExtractor::ZipStreamExtractor(const std::string& extractDir)
+    : state(std::make_unique<State>(extractDir)) {}
+
+ZipStreamExtractor::~ZipStreamExtractor() = default;
+
+bool ZipStreamExtractor::reset() {
+    const fs::path root = state->root;
+    state = std::make_unique<State>(root.string());
+
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    fs::create_directories(root, ec);
+    if (ec) return state->fail("Failed to prepare " + root.string() + ": " + ec.message());
+    return true;
+}
+
+bool ZipStreamExtractor::feed(const char* data, size_t length) {
+    State& s = *state;
+    while (length > 0) {
+        switch (s.stage) {
+            case State::Stage::Signature: {
+                if (!s.take(4, data, length)) return true;
+                const std::uint32_t signature = readLE32(s.pending.data());
+                if (signature == LOCAL_HEADER_SIGNATURE) {
+                    s.stage = State::Stage::Header;  // Keep the signature, it is part of the header
+                } else if (signature == CENTRAL_HEADER_SIGNATURE || signature == END_OF_CENTRAL_SIGNATURE) {
+                    s.pending.clear();
+                    s.stage = State::Stage::Done;
+                } else {
+                    return s.fail("Not a zip archive or corrupt local header");
+                }
+                break;
+            }
+            case State::Stage::Header: {
+                if (!s.take(LOCAL_HEADER_SIZE, data, length)) return true;
+                const size_t headerSize = LOCAL_HEADER_SIZE + readLE16(s.pending.data() + 26) +
+                                          readLE16(s.pending.data() + 28);
+                if (!s.take(headerSize, data, length)) return true;
+                if (!s.beginEntry()) return false;
+                break;
+            }
+            case State::Stage::Data:
+                if (!s.processData(data, length)) return false;
+                break;
+            case State::Stage::Descriptor:
+                if (!s.parseDescriptor(data, length)) return false;
+                break;
+            case State::Stage::Done:
+                return true;  // Central directory and comment carry nothing we need
+            case State::Stage::Failed:
+                return false;
+        }
+    }
+    return s.stage != State::Stage::Failed;
+}
+
+bool ZipStreamExtractor::finish() {
+    if (state->stage == State::Stage::Done) return state->writer.flush() || state->fail(state->writer.error());
+    if (state->stage != State::Stage::Failed) state->fail("Archive ended before its central directory");
+    return false;
+}
+
+bool ZipStreamExtractor::unsupported() const {
+    return state->unsupported;
+}
+
+const std::string& ZipStreamExtractor::error() const {
+    return state->error;
+}
+
+size_t ZipStreamExtractor::entriesExtracted() const {
+    return state->entries;
+}
+
+std::uint64_t ZipStreamExtractor::bytesExtracted() const {
+    return state->totalBytes;
+}
+
+ArchiveFormat detectArchiveFormat(const char* data, size_t length) {
+    if (length < 4) return ArchiveFormat::Unknown;
+    const std::uint32_t magic = readLE32(data);
+    if (magic == LOCAL_HEADER_SIGNATURE || magic == END_OF_CENTRAL_SIGNATURE) return ArchiveFormat::Zip;
+    if ((magic & 0xFFFF) == GZIP_MAGIC) return ArchiveFormat::Gzip;
+    if (magic == ZSTD_MAGIC) return ArchiveFormat::Zstd;
+    return ArchiveFormat::Unknown;
+}
+
+// Number field of a tar header: octal text, or big-endian base-256 when the high bit is set (GNU)
+static bool parseTarNumber(const char* field, size_t size, std::uint64_t& value) {
+    value = 0;
+    const auto* bytes = reinterpret_cast<const unsigned char*>(field);
+    if (bytes[0] & 0x80) {
+        for (size_t i = 1; i < size; ++i) value = (value << 8) | bytes[i];
+        return true;
+    }
+    size_t i = 0;
+    while (i < size && field[i] == ' ') ++i;
+    for (; i < size && field[i] >= '0' && field[i] <= '7'; ++i) value = (value << 3) | static_cast<unsigned>(field[i] - '0');
+    return i == size || field[i] == '\0' || field[i] == ' ';
+}
+
+// NUL-terminated string field
+static std::string tarString(const char* field, size_t size) {
+    return std::string(field, std::find(field, field + size, '\0'));
+}
+
+struct TarStreamExtractor::State {
+    enum class Codec { Unknown, None, Gzip, Zstd };
+    enum class Stage { Header, Meta, Data, Padding, Done, Failed };
+
+    // Symlink recreated after everything else, so no entry can be written through one
+    struct Link {
+        fs::path path;
+        fs::path target;  // As stored, relative to the link's directory
+    };
+
+    fs::path root;
+    std::string error;
+    size_t entries = 0;
+    std::uint64_t totalBytes = 0;
+
+    // Decompression
+    Codec codec = Codec::Unknown;
+    std::string sniffed;  // First bytes, until the codec is known
+    bool codecEnded = true;  // Between compressed frames/members
+    z_stream inflater = {};
+    bool inflaterReady = false;
+#ifdef PURR_HAVE_ZSTD
+    ZSTD_DStream* zstd = nullptr;
+#endif
+    std::vector<char> output;
+
+    // Tar layer
+    Stage stage = Stage::Header;
+    std::string block;  // Header being collected
+    std::string meta;   // Long name or pax record being collected
+    char metaType = 0;
+    std::uint64_t remaining = 0;
+    std::uint64_t padding = 0;
+    std::string longName, longLink, paxPath, paxLinkPath;
+    std::uint64_t paxSize = 0;
+    bool hasPaxSize = false;
+    std::uint32_t mode = 0;
+    fs::path current;
+    std::uint64_t entrySize = 0;
+    FileSink sink;
+    BulkFileWriter writer;
+    std::vector<char> smallFile;  // Whole entry, when it is small
+    bool buffering = false;
+    std::vector<Link> links;
+    std::set<fs::path> linkPaths;  // Relative paths of links, which nothing may be placed beneath
+
+    explicit State(const std::string& extractDir) : root(extractDir), output(INFLATE_CHUNK_SIZE) {}
+
+    ~State() {
+        if (inflaterReady) inflateEnd(&inflater);
+#ifdef PURR_HAVE_ZSTD
+        if (zstd) ZSTD_freeDStream(zstd);
+#endif
+    }
+
+    bool fail(const std::string& message) {
+        error = message;
+        stage = Stage::Failed;
+        sink.close();
+        return false;
+    }
+
+    // A path through a link would be written, or later resolved, wherever the link points
+    bool beneathLink(const fs::path& relative) const {
+        for (fs::path parent = relative.parent_path(); !parent.empty(); parent = parent.parent_path()) {
+            if (linkPaths.count(parent)) return true;
+        }
+        return false;
+    }
+
+    static bool inside(const fs::path& path, const fs::path& base) {
+        const fs::path relative = path.lexically_relative(base);
+        return !relative.empty() && *relative.begin() != "..";
+    }
+
+    bool chooseCodec() {
+        switch (detectArchiveFormat(sniffed.data(), sniffed.size())) {
+            case ArchiveFormat::Gzip:
+                // 16 + MAX_WBITS: gzip wrapper, checked against its own CRC and length
+                if (inflateInit2(&inflater, 16 + MAX_WBITS) != Z_OK) return fail("Failed to initialize zlib");
+                inflaterReady = true;
+                codec = Codec::Gzip;
+                return true;
+            case ArchiveFormat::Zstd:
+#ifdef PURR_HAVE_ZSTD
+                zstd = ZSTD_createDStream();
+                if (!zstd || ZSTD_isError(ZSTD_initDStream(zstd))) return fail("Failed to initialize zstd");
+                codec = Codec::Zstd;
+                return true;
+#else
+                return fail("zstd archives are not supported by this build");
+#endif
+            case ArchiveFormat::Zip:
+                return fail("This is a zip archive, not a tarball");
+            case ArchiveFormat::Unknown:
+                codec = Codec::None;  // Plain tar; the header checksum tells if it is not
+                return true;
+        }
+        return true;
+    }
+
+    bool decompress(const char* data, size_t length) {
+        if (codec == Codec::None) return untar(data, length);
+
+        if (codec == Codec::Gzip) {
+            inflater.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            inflater.avail_in = static_cast<uInt>(length);
+            while (true) {
+                if (codecEnded) {
+                    // Concatenated gzip members (pigz, appended archives) form one stream;
+                    // anything after the end of the tar is ignored, like gzip -d does
+                    if (inflater.avail_in == 0 || stage == Stage::Done) break;
+                    inflateReset(&inflater);
+                    codecEnded = false;
+                }
+                inflater.next_out = reinterpret_cast<Bytef*>(output.data());
+                inflater.avail_out = static_cast<uInt>(output.size());
+                const int rc = inflate(&inflater, Z_NO_FLUSH);
+                if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) return fail("Corrupt gzip data");
+                if (!untar(output.data(), output.size() - inflater.avail_out)) return false;
+                if (rc == Z_STREAM_END) codecEnded = true;
+                // A full output buffer may leave more inside zlib even with the input used up
+                else if (inflater.avail_in == 0 && inflater.avail_out != 0) break;
+            }
+            return true;
+        }
+
+#ifdef PURR_HAVE_ZSTD
+        ZSTD_inBuffer in = {data, length, 0};
+        for (bool outputFull = false; in.pos < in.size || outputFull;) {
+            if (codecEnded && stage == Stage::Done) break;
+            ZSTD_outBuffer out = {output.data(), output.size(), 0};
+            const size_t rc = ZSTD_decompressStream(zstd, &out, &in);
+            if (ZSTD_isError(rc)) return fail(std::string("Corrupt zstd data: ") + ZSTD_getErrorName(rc));
+            codecEnded = rc == 0;  // At a frame boundary
+            outputFull = out.pos == out.size;
+            if (!untar(output.data(), out.pos)) return false;
+        }
+#endif
+        return true;
+    }
+
+    // Feed decompressed tar bytes through the header/data state machine
+    bool untar(const char* data, size_t length) {
+        while (length > 0) {
+            switch (stage) {
+                case Stage::Header: {
+                    const size_t count = std::min(TAR_BLOCK_SIZE - block.size(), length);
+                    block.append(data, count);
+                    data += count;
+                    length -= count;
+                    if (block.size() == TAR_BLOCK_SIZE && !beginEntry()) return false;
+                    break;
+                }
+                case Stage::Meta: {
+                    const size_t count = static_cast<size_t>(std::min<std::uint64_t>(remaining, length));
+                    meta.append(data, count);
+                    data += count;
+                    length -= count;
+                    remaining -= count;
+                    if (remaining == 0) endMeta();
+                    break;
+                }
+                case Stage::Data: {
+                    const size_t count = static_cast<size_t>(std::min<std::uint64_t>(remaining, length));
+                    if (buffering) {
+                        smallFile.insert(smallFile.end(), data, data + count);
+                    } else if (sink.isOpen() && sink.write(data, count) != count) {
+                        return fail("Failed to write " + sink.getPath());
+                    }
+                    data += count;
+                    length -= count;
+                    remaining -= count;
+                    totalBytes += count;
+                    if (remaining == 0 && !endFile()) return false;
+                    break;
+                }
+                case Stage::Padding: {
+                    const size_t count = static_cast<size_t>(std::min<std::uint64_t>(padding, length));
+                    data += count;
+                    length -= count;
+                    padding -= count;
+                    if (padding == 0) stage = Stage::Header;
+                    break;
+                }
+                case Stage::Done:
+                    return true;  // Zero blocks up to the record size
+                case Stage::Failed:
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void skipTo(std::uint64_t size) {
+        padding = (TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+        stage = padding > 0 ? Stage::Padding : Stage::Header;
+    }
+
+    bool beginEntry() {
+        const std::string header = std::move(block);
+        block.clear();
+
+        // Two zero blocks end the archive; accept one, some writers stop there
+        if (std::all_of(header.begin(), header.end(), [](char c) { return c == '\0'; })) {
+            stage = Stage::Done;
+            return true;
+        }
+
+        // Checksum: byte sum of the header with the checksum field read as spaces
+        std::uint64_t recorded = 0;
+        unsigned sum = 0;
+        for (size_t i = 0; i < TAR_BLOCK_SIZE; ++i) {
+            sum += (i >= 148 && i < 156) ? ' ' : static_cast<unsigned char>(header[i]);
+        }
+        if (!parseTarNumber(header.data() + 148, 8, recorded) || recorded != sum) {
+            return fail("Not a tar archive or corrupt header");
+        }
+
+        std::uint64_t size = 0;
+        std::uint64_t headerMode = 0;
+        if (!parseTarNumber(header.data() + 124, 12, size)) return fail("Corrupt size in tar header");
+        parseTarNumber(header.data() + 100, 8, headerMode);
+        const char type = header[156];
+        if (hasPaxSize && type != 'x' && type != 'g') size = paxSize;
+
+        // GNU long names and pax records describe the entry that follows
+        if (type == 'L' || type == 'K' || type == 'x' || type == 'g') {
+            if (size > MAX_TAR_META_SIZE) return fail("Oversized tar metadata record");
+            meta.clear();
+            metaType = type;
+            remaining = size;
+            stage = Stage::Meta;
+            if (size == 0) endMeta();
+            return true;
+        }
+
+        std::string name = tarString(header.data(), 100);
+        if (header.compare(257, 5, "ustar") == 0) {
+            const std::string prefix = tarString(header.data() + 345, 155);
+            if (!prefix.empty()) name = prefix + "/" + name;
+        }
+        if (!longName.empty()) name = longName;
+        if (!paxPath.empty()) name = paxPath;
+        std::string linkName = tarString(header.data() + 157, 100);
+        if (!longLink.empty()) linkName = longLink;
+        if (!paxLinkPath.empty()) linkName = paxLinkPath;
+        longName.clear();
+        longLink.clear();
+        paxPath.clear();
+        paxLinkPath.clear();
+        hasPaxSize = false;
+
+        // "./" and friends name the root itself
+        fs::path relative;
+        const bool isRoot = std::all_of(name.begin(), name.end(), [](char c) { return c == '.' || c == '/'; });
+        if (!isRoot && !safeRelativePath(name, relative)) return fail("Unsafe path in archive: " + name);
+        if (beneathLink(relative) || (type != '2' && linkPaths.count(relative))) {
+            return fail("Path through a symlink in archive: " + name);
+        }
+        const fs::path target = root / relative;
+        std::error_code ec;
+
+        switch (type) {
+            case '0': case '\0': case '7': {
+                fs::create_directories(target.parent_path(), ec);
+                if (ec) return fail("Failed to create directory for " + name + ": " + ec.message());
+                buffering = size <= BulkFileWriter::SMALL_FILE_LIMIT;
+                if (buffering) {
+                    smallFile.clear();
+                    smallFile.reserve(static_cast<size_t>(size));
+                } else {
+                    if (!openReplacing(sink, target)) return fail("Failed to create " + target.string());
+                    sink.preallocate(size);
+                }
+                current = target;
+                mode = static_cast<std::uint32_t>(headerMode);
+                entrySize = size;
+                remaining = size;
+                stage = Stage::Data;
+                return size > 0 ? true : endFile();
+            }
+            case '5':
+                if (!isRoot) fs::create_directories(target, ec);
+                if (ec) return fail("Failed to create directory " + name + ": " + ec.message());
+                ++entries;
+                break;
+            case '1': {
+                fs::path source;
+                if (!safeRelativePath(linkName, source) || beneathLink(source) || linkPaths.count(source)) {
+                    return fail("Unsafe hard link in archive: " + name);
+                }
+                if (!writer.flush()) return fail(writer.error());  // The source may still be queued
+                fs::create_directories(target.parent_path(), ec);
+                fs::remove(target, ec);
+                fs::create_hard_link(root / source, target, ec);
+                if (ec) {
+                    ec.clear();
+                    fs::copy_file(root / source, target, fs::copy_options::overwrite_existing, ec);
+                }
+                if (ec) return fail("Failed to link " + name + ": " + ec.message());
+                ++entries;
+                break;
+            }
+            case '2': {
+                // Relative targets only, and resolving inside the extraction root
+                const fs::path resolved = (relative.parent_path() / fs::path(linkName)).lexically_normal();
+                if (linkName.empty() || fs::path(linkName).has_root_path() || resolved.empty() ||
+                    *resolved.begin() == "..") {
+                    return fail("Unsafe symlink in archive: " + name + " -> " + linkName);
+                }
+                links.push_back({target, fs::path(linkName)});
+                linkPaths.insert(relative);
+                ++entries;
+                break;
+            }
+            default:
+                break;  // Devices, FIFOs: nothing a launcher needs
+        }
+        skipTo(type == '5' || type == '1' || type == '2' ? 0 : size);
+        return true;
+    }
+
+    void endMeta() {
+        const std::string value = tarString(meta.data(), meta.size());
+        if (metaType == 'L') longName = value;
+        if (metaType == 'K') longLink = value;
+        if (metaType == 'x') {
+            // Records are "<length> <key>=<value>\n"
+            for (size_t offset = 0; offset < meta.size();) {
+                const size_t space = meta.find(' ', offset);
+                if (space == std::string::npos) break;
+                const size_t recordLength = std::strtoull(meta.c_str() + offset, nullptr, 10);
+                if (recordLength == 0 || offset + recordLength > meta.size()) break;
+                const std::string record = meta.substr(space + 1, offset + recordLength - space - 2);
+                const size_t equals = record.find('=');
+                if (equals != std::string::npos) {
+                    const std::string key = record.substr(0, equals);
+                    if (key == "path") paxPath = record.substr(equals + 1);
+                    if (key == "linkpath") paxLinkPath = record.substr(equals + 1);
+                    if (key == "size") {
+                        paxSize = std::strtoull(record.c_str() + equals + 1, nullptr, 10);
+                        hasPaxSize = true;
+                    }
+                }
+                offset += recordLength;
+            }
+        }
+        skipTo(meta.size());
+    }
+
+    bool endFile() {
+        if (buffering) {
+            const std::uint32_t fileMode = (mode & 0111) ? (mode & 0777) : 0644;
+            if (!writer.write(current.string(), std::move(smallFile), fileMode)) return fail(writer.error());
+            smallFile = std::vector<char>();
+            ++entries;
+            skipTo(entrySize);
+            return true;
+        }
+        if (!sink.close()) return fail("Failed to write " + current.string());
+#ifndef _WIN32
+        if (mode & 0111) {
+            std::error_code ec;
+            fs::permissions(current, static_cast<fs::perms>(mode & 0777), ec);
+        }
+#endif
+        ++entries;
+        skipTo(entrySize);
+        return true;
+    }
+
+    // Targets were only checked as text. One link may point through another, so each is checked
+    // again against the real tree: once all exist, every link must still resolve inside the root.
+    bool createLinks() {
+        if (!writer.flush()) return fail(writer.error());  // Copies below read link targets
+        std::error_code ec;
+        const fs::path realRoot = fs::weakly_canonical(root, ec);
+        if (ec) return fail("Failed to resolve " + root.string() + ": " + ec.message());
+
+        std::vector<fs::path> created;
+        auto undo = [&](const std::string& message) {
+            std::error_code ignored;
+            for (const auto& path : created) fs::remove(path, ignored);
+            links.clear();
+            return fail(message);
+        };
+
+        for (const auto& link : links) {
+            fs::create_directories(link.path.parent_path(), ec);
+            if (!inside(fs::weakly_canonical(link.path.parent_path(), ec), realRoot) || ec) {
+                return undo("Symlink leaves the extraction root: " + link.path.string());
+            }
+            fs::remove(link.path, ec);
+            fs::create_symlink(link.target, link.path, ec);
+            if (!ec) {
+                created.push_back(link.path);
+                continue;
+            }
+
+            // Windows without Developer Mode cannot create symlinks: a copy serves the same reads
+            const fs::path source = fs::weakly_canonical(link.path.parent_path() / link.target, ec);
+            if (ec || !inside(source, realRoot)) return undo("Symlink leaves the extraction root: " + link.path.string());
+            fs::copy(source, link.path, fs::copy_options::recursive | fs::copy_options::overwrite_existing, ec);
+            if (ec) return undo("Failed to create symlink " + link.path.string() + ": " + ec.message());
+        }
+
+        for (const auto& path : created) {
+            const fs::path resolved = fs::weakly_canonical(path, ec);
+            if (ec || !inside(resolved, realRoot)) return undo("Symlink leaves the extraction root: " + path.string());
+        }
+        links.clear();
+        return true;
+    }
+};
+
+TarStreamExtractor::TarStreamExtractor(const std::string& extractDir)
+    : state(std::make_unique<State>(extractDir)) {}
+
+TarStreamExtractor::~TarStreamExtractor() = default;
+
+bool TarStreamExtractor::reset() {
+    const fs::path root = state->root;
+    state = std::make_unique<State>(root.string());
 
-    if (result != 0) {
-        std::cerr << "Extraction failed with exit code: " << result << std::endl;
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    fs::create_directories(root, ec);
+    if (ec) return state->fail("Failed to prepare " + root.string() + ": " + ec.message());
+    return true;
+}
+
+bool TarStreamExtractor::feed(const char* data, size_t length) {
+    State& s = *state;
+    if (s.stage == State::Stage::Failed) return false;
+    if (s.codec == State::Codec::Unknown) {
+        const size_t count = std::min(length, 4 - s.sniffed.size());
+        s.sniffed.append(data, count);
+        data += count;
+        length -= count;
+        if (s.sniffed.size() < 4) return true;
+        if (!s.chooseCodec() || !s.decompress(s.sniffed.data(), s.sniffed.size())) return false;
+    }
+    return length == 0 || s.decompress(data, length);
+}
+
+bool TarStreamExtractor::finish() {
+    State& s = *state;
+    if (s.stage == State::Stage::Failed) return false;
+    // Short archives (under 4 bytes) never got past sniffing
+    if (s.codec == State::Codec::Unknown && !s.sniffed.empty()) {
+        if (!s.chooseCodec() || !s.decompress(s.sniffed.data(), s.sniffed.size())) return false;
+    }
+    const bool complete = s.stage == State::Stage::Done || (s.stage == State::Stage::Header && s.block.empty() && s.entries > 0);
+    if (!complete || !s.codecEnded) return s.fail("Archive ended before its last entry");
+    return s.createLinks();
+}
+
+const std::string& TarStreamExtractor::error() const {
+    return state->error;
+}
+
+size_t TarStreamExtractor::entriesExtracted() const {
+    return state->entries;
+}
+
+std::uint64_t TarStreamExtractor::bytesExtracted() const {
+    return state->totalBytes;
+}
+
+bool extractTarball(const std::string& path, const std::string& extractDir) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Archive does not exist: " << path << std::endl;
+        return false;
+    }
+
+    std::cout << "Extracting archive: " << path << std::endl;
+    TarStreamExtractor extractor(extractDir);
+    std::vector<char> buffer(INFLATE_CHUNK_SIZE);
+    bool ok = true;
+    while (ok && in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (in.gcount() > 0) ok = extractor.feed(buffer.data(), static_cast<size_t>(in.gcount()));
+    }
+    if (!ok || !extractor.finish()) {
+        std::cerr << "Extraction failed: " << extractor.error() << std::endl;
         std::cerr << "The archive might be corrupted or incomplete." << std::endl;
         return false;
     }
 
-    std::cout << "Extraction completed successfully." << std::endl;
+    std::cout << "Extraction completed successfully (" << extractor.entriesExtracted() << " entries, "
+             << (extractor.bytesExtracted() / (1024 * 1024)) << " MB)." << std::endl;
     return true;
-}
\ No newline at end of file
+}
+
+bool moveTreeInto(const std::string& sourceDir, const std::string& destDir, const std::string& backupDir) {
+    // Every rename so far, as (from, to), so a failure can undo them in reverse
+    std::vector<std::pair<fs::path, fs::path>> moves;
+    try {
+        // Collect first: renaming while iterating would change the directories being walked
+        std::vector<fs::path> files;
+        for (const auto& entry : fs::recursive_directory_iterator(sourceDir)) {
+            if (entry.is_directory()) {
+                fs::create_directories(fs::path(destDir) / entry.path().lexically_relative(sourceDir));
+            } else {
+                files.push_back(entry.path());
+            }
+        }
+
+        for (const auto& file : files) {
+            const fs::path relative = file.lexically_relative(sourceDir);
+            const fs::path target = fs::path(destDir) / relative;
+            if (fs::exists(fs::symlink_status(target))) {
+                const fs::path backup = fs::path(backupDir) / relative;
+                fs::create_directories(backup.parent_path());
+                fs::rename(target, backup);
+                moves.emplace_back(target, backup);
+            }
+            fs::rename(file, target);
+            moves.emplace_back(file, target);
+        }
+    } catch (const fs::filesystem_error& e) {
+        std::cerr << "Failed to move extracted files into " << destDir << ": " << e.what() << std::endl;
+        for (auto it = moves.rbegin(); it != moves.rend(); ++it) {
+            std::error_code ignored;
+            fs::rename(it->second, it->first, ignored);
+        }
+        return false;
+    }
+
+    std::error_code ec;
+    fs::remove_all(sourceDir, ec);  // Only empty directories are left
+    return true;
+}
+
+// Single background thread deleting retired trees; the destructor (at exit) drains the queue
+class TreeRemover {
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<fs::path> queue;
+    std::thread thread;
+    bool stopping = false;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            const fs::path path = std::move(queue.front());
+            queue.pop_front();
+
+            lock.unlock();
+            std::error_code ec;
+            fs::remove_all(path, ec);
+            if (ec) std::cerr << "Failed to delete " << path.string() << ": " << ec.message() << std::endl;
+            lock.lock();
+        }
+    }
+
+public:
+    ~TreeRemover() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (thread.joinable()) thread.join();
+    }
+
+    void add(const fs::path& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(path);
+        if (!thread.joinable()) thread = std::thread(&TreeRemover::run, this);
+        wake.notify_one();
+    }
+};
+
+void removeTreeInBackground(const std::string& path) {
+    static TreeRemover remover;
+    remover.add(fs::path(path));
+}
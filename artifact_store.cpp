@@ -0,0 +1,246 @@
+#include "include/artifact_store.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/fs.h>
+#endif
+
+namespace fs = std::filesystem;
+
+ArtifactStore& ArtifactStore::getInstance() {
+    static ArtifactStore instance;
+    return instance;
+}
+
+void ArtifactStore::setRoot(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(rootMutex);
+    root = directory;
+}
+
+bool ArtifactStore::isEnabled() const {
+    std::lock_guard<std::mutex> lock(rootMutex);
+    return !root.empty();
+}
+
+std::string ArtifactStore::objectPath(HashAlgorithm algorithm, const std::string& digest) const {
+    const size_t expectedLength = algorithm == HashAlgorithm::SHA256 ? 64 : 40;
+    if (digest.size() != expectedLength ||
+        !std::all_of(digest.begin(), digest.end(), [](unsigned char c) { return std::isxdigit(c); })) {
+        return "";
+    }
+
+    std::string lower = digest;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    std::lock_guard<std::mutex> lock(rootMutex);
+    if (root.empty()) return "";
+    const char* bucket = algorithm == HashAlgorithm::SHA256 ? "sha256" : "sha1";
+    return (fs::path(root) / bucket / lower.substr(0, 2) / lower).string();
+}
+
+// Sibling temp name so the final rename stays on one filesystem; random so concurrent launchers don't collide
+static std::string tempPathFor(const std::string& path) {
+    static thread_local std::mt19937_64 rng{std::random_device{}()};
+    return path + ".tmp" + std::to_string(rng() % 1000000000ULL);
+}
+
+// Copy-on-write clone (Btrfs, XFS, bcachefs); other platforms fall through to hardlink/copy
+static bool reflinkFile(const std::string& source, const std::string& dest) {
+#ifdef __linux__
+    const int src = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (src < 0) return false;
+    const int dst = open(dest.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (dst < 0) {
+        close(src);
+        return false;
+    }
+    const bool cloned = ioctl(dst, FICLONE, src) == 0;
+    close(dst);
+    close(src);
+    if (!cloned) unlink(dest.c_str());
+    return cloned;
+#else
+    (void)source;
+    (void)dest;
+    return false;
+#endif
+}
+
+// Independent copy of source at dest, cloned where the filesystem allows it
+static bool cloneFile(const std::string& source, const std::string& dest) {
+    if (reflinkFile(source, dest)) return true;
+
+    std::error_code ec;
+    fs::copy_file(source, dest, fs::copy_options::overwrite_existing, ec);
+    return !ec;
+}
+
+// Materialize source at dest sharing storage when the filesystem allows it
+static bool placeFile(const std::string& source, const std::string& dest) {
+    if (reflinkFile(source, dest)) return true;
+
+    std::error_code ec;
+    fs::create_hard_link(source, dest, ec);
+    if (!ec) return true;
+
+    // Different volume or no link support
+    return cloneFile(source, dest);
+}
+
+// Sidecar recording the size and mtime of an object when its digest was last checked
+static std::string markerPathFor(const std::string& object) {
+    return object + ".verified";
+}
+
+// "<size> <mtime>" of the object as it is now, empty if it cannot be read
+static std::string objectStamp(const std::string& object) {
+    std::error_code ec;
+    const auto size = fs::file_size(object, ec);
+    if (ec) return "";
+    const auto mtime = fs::last_write_time(object, ec);
+    if (ec) return "";
+    return std::to_string(size) + " " + std::to_string(mtime.time_since_epoch().count());
+}
+
+static void writeMarker(const std::string& object) {
+    const std::string stamp = objectStamp(object);
+    if (stamp.empty()) return;
+    std::ofstream marker(markerPathFor(object), std::ios::trunc);
+    marker << stamp;
+}
+
+// Drop a bad object so the caller downloads it again and add() can store a good copy
+static void evictObject(const std::string& object, const std::string& reason) {
+    std::cerr << "Evicting " << object << " from artifact store: " << reason << std::endl;
+    std::error_code ec;
+    fs::remove(markerPathFor(object), ec);
+    fs::remove(object, ec);
+}
+
+// Trust an object once its digest has been checked; the marker goes stale as soon as the
+// file is written through a hardlink or replaced, and the object is hashed again
+static bool verifyObject(HashAlgorithm algorithm, const std::string& digest, const std::string& object) {
+    const std::string stamp = objectStamp(object);
+    if (stamp.empty()) return false;
+
+    std::ifstream markerFile(markerPathFor(object));
+    std::string marker;
+    std::getline(markerFile, marker);
+    if (marker == stamp) return true;
+
+    const std::string actual = computeFileHash(object, algorithm);
+    if (!digestEquals(actual, digest)) {
+        evictObject(object, std::string(hashAlgorithmName(algorithm)) + " is " + (actual.empty() ? "unreadable" : actual));
+        return false;
+    }
+    writeMarker(object);
+    return true;
+}
+
+bool ArtifactStore::install(HashAlgorithm algorithm, const std::string& digest, const std::string& destPath,
+                            std::uint64_t expectedSize) {
+    const std::string object = objectPath(algorithm, digest);
+    if (object.empty()) return false;
+
+    std::error_code ec;
+    const auto size = fs::file_size(object, ec);
+    if (ec) {
+        ++misses;
+        return false;
+    }
+    if (expectedSize > 0 && size != expectedSize) {
+        evictObject(object, "size " + std::to_string(size) + ", expected " + std::to_string(expectedSize));
+        ++misses;
+        return false;
+    }
+    if (!verifyObject(algorithm, digest, object)) {
+        ++misses;
+        return false;
+    }
+
+    if (const auto parent = fs::path(destPath).parent_path(); !parent.empty()) {
+        fs::create_directories(parent, ec);
+    }
+
+    // Link under a temp name and rename, so an existing (possibly linked) dest is replaced, never written through
+    const std::string tempPath = tempPathFor(destPath);
+    if (!placeFile(object, tempPath)) {
+        fs::remove(tempPath, ec);
+        ++misses;
+        return false;
+    }
+    fs::rename(tempPath, destPath, ec);
+    if (ec) {
+        std::cerr << "Failed to install " << destPath << " from artifact store: " << ec.message() << std::endl;
+        fs::remove(tempPath, ec);
+        ++misses;
+        return false;
+    }
+
+    ++hits;
+    bytesReused += size;
+    return true;
+}
+
+void ArtifactStore::add(HashAlgorithm algorithm, const std::string& digest, const std::string& sourcePath) {
+    const std::string object = objectPath(algorithm, digest);
+    if (object.empty()) return;
+
+    std::error_code ec;
+    if (fs::exists(object, ec)) return;
+
+    fs::create_directories(fs::path(object).parent_path(), ec);
+    if (ec) {
+        std::cerr << "Failed to create artifact store directory: " << ec.message() << std::endl;
+        return;
+    }
+
+    // Never a hardlink: the instance may later rewrite its file in place
+    const std::string tempPath = tempPathFor(object);
+    if (!cloneFile(sourcePath, tempPath)) {
+        fs::remove(tempPath, ec);
+        std::cerr << "Failed to add " << sourcePath << " to artifact store" << std::endl;
+        return;
+    }
+    fs::rename(tempPath, object, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);
+        return;
+    }
+    writeMarker(object);
+    ++added;
+}
+
+ArtifactStoreStats ArtifactStore::getStats() const {
+    ArtifactStoreStats stats;
+    stats.hits = hits.load();
+    stats.misses = misses.load();
+    stats.added = added.load();
+    stats.bytesReused = bytesReused.load();
+    return stats;
+}
+
+std::string defaultArtifactStoreDir() {
+#ifdef _WIN32
+    if (const char* localAppData = std::getenv("LOCALAPPDATA"); localAppData && *localAppData) {
+        return (fs::path(localAppData) / "PurrLauncher" / "store").string();
+    }
+#else
+    if (const char* cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome && *cacheHome) {
+        return (fs::path(cacheHome) / "purrlauncher" / "store").string();
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return (fs::path(home) / ".cache" / "purrlauncher" / "store").string();
+    }
+#endif
+    return "store";
+}
@@ -0,0 +1,314 @@
+// Download throughput benchmark: runs downloadFile, httpGet and downloadBatch against
+// HttpStandin on 127.0.0.1 and reports MB/s, requests/s and p50/p99 latency. Offline and
+// deterministic enough to compare two builds on the same machine.
+#include "http_standin.h"
+#include "download.h"
+#include "http_client.h"
+#include "progress.h"
+
+#include <curl/curl.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+
+struct BenchOptions {
+    std::uint64_t fileSize = 64ull * 1024 * 1024;  // downloadFile scenario
+    int fileRuns = 5;
+    int gets = 200;                                  // httpGet scenario
+    size_t batchCount = 500;                         // downloadBatch scenario
+    std::uint64_t batchFileSize = 64 * 1024;
+    int batchRuns = 3;
+    int batchConcurrency = 8;
+    StandinOptions server;
+    bool jsonOutput = false;
+    bool verbose = false;  // Keep the launcher's own console output
+};
+
+struct ScenarioResult {
+    std::string name;
+    size_t requests = 0;
+    size_t failures = 0;
+    std::uint64_t bytes = 0;
+    double seconds = 0.0;
+    std::vector<double> latenciesMs;
+    std::string latencySource;  // "client" or "server"
+};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --file-mb N          Size of the downloadFile payload (default 64)\n"
+              << "  --file-runs N        downloadFile repetitions (default 5)\n"
+              << "  --gets N             httpGet requests (default 200)\n"
+              << "  --batch-count N      Files per downloadBatch run (default 500)\n"
+              << "  --batch-kb N         Size of each batch file (default 64)\n"
+              << "  --batch-runs N       downloadBatch repetitions (default 3)\n"
+              << "  --concurrency N      downloadBatch maxConcurrent (default 8)\n"
+              << "  --latency-ms N       Server delay before every response (default 0)\n"
+              << "  --bandwidth-mb N     Per-connection cap in MB/s, 0 for none (default 0)\n"
+              << "  --no-ranges          Server ignores Range (no segmented downloads)\n"
+              << "  --chunked            Server sends chunked bodies without Content-Length\n"
+              << "  --json               Print results as JSON\n"
+              << "  --verbose            Keep download progress output\n";
+}
+
+bool parseOptions(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto next = [&](double& value) {
+            if (i + 1 >= argc) return false;
+            try {
+                value = std::stod(argv[++i]);
+            } catch (const std::exception&) {
+                return false;
+            }
+            return value >= 0;
+        };
+
+        double value = 0;
+        if (arg == "--no-ranges") {
+            options.server.ranges = false;
+        } else if (arg == "--chunked") {
+            options.server.chunked = true;
+        } else if (arg == "--json") {
+            options.jsonOutput = true;
+        } else if (arg == "--verbose") {
+            options.verbose = true;
+        } else if (arg == "--file-mb" && next(value)) {
+            options.fileSize = static_cast<std::uint64_t>(value * 1024 * 1024);
+        } else if (arg == "--file-runs" && next(value)) {
+            options.fileRuns = static_cast<int>(value);
+        } else if (arg == "--gets" && next(value)) {
+            options.gets = static_cast<int>(value);
+        } else if (arg == "--batch-count" && next(value)) {
+            options.batchCount = static_cast<size_t>(value);
+        } else if (arg == "--batch-kb" && next(value)) {
+            options.batchFileSize = static_cast<std::uint64_t>(value * 1024);
+        } else if (arg == "--batch-runs" && next(value)) {
+            options.batchRuns = static_cast<int>(value);
+        } else if (arg == "--concurrency" && next(value)) {
+            options.batchConcurrency = std::max(1, static_cast<int>(value));
+        } else if (arg == "--latency-ms" && next(value)) {
+            options.server.latency = std::chrono::milliseconds(static_cast<long long>(value));
+        } else if (arg == "--bandwidth-mb" && next(value)) {
+            options.server.bandwidthBytesPerSecond = static_cast<std::uint64_t>(value * 1024 * 1024);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Nearest-rank percentile
+double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(values.size())));
+    return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+ScenarioResult benchGet(HttpStandin& server, const BenchOptions& options) {
+    ScenarioResult result;
+    result.name = "httpGet";
+    result.latencySource = "client";
+    const std::string url = server.url("/api/status.json");
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < options.gets; ++i) {
+        const auto requestStart = std::chrono::steady_clock::now();
+        const std::string body = httpGet(url);
+        result.latenciesMs.push_back(secondsSince(requestStart) * 1000.0);
+        ++result.requests;
+        if (body.empty()) ++result.failures;
+        result.bytes += body.size();
+    }
+    result.seconds = secondsSince(start);
+    return result;
+}
+
+ScenarioResult benchFile(HttpStandin& server, const BenchOptions& options, const fs::path& workDir) {
+    ScenarioResult result;
+    result.name = "downloadFile";
+    result.latencySource = "client";
+    const std::string url = server.url("/files/large.bin");
+    const fs::path output = workDir / "large.bin";
+
+    for (int i = 0; i < options.fileRuns; ++i) {
+        std::error_code ec;
+        fs::remove(output, ec);
+
+        const auto start = std::chrono::steady_clock::now();
+        const bool ok = downloadFile(url, output.string());
+        const double seconds = secondsSince(start);
+
+        result.seconds += seconds;
+        result.latenciesMs.push_back(seconds * 1000.0);
+        ++result.requests;
+        if (!ok || fs::file_size(output, ec) != options.fileSize) {
+            ++result.failures;
+        } else {
+            result.bytes += options.fileSize;
+        }
+    }
+    return result;
+}
+
+ScenarioResult benchBatch(HttpStandin& server, const BenchOptions& options, const fs::path& workDir) {
+    ScenarioResult result;
+    result.name = "downloadBatch";
+    result.latencySource = "server";
+
+    std::vector<DownloadJob> jobs;
+    for (size_t i = 0; i < options.batchCount; ++i) {
+        const std::string name = "lib" + std::to_string(i) + ".jar";
+        DownloadJob job;
+        job.url = server.url("/libraries/" + name);
+        job.outputPath = (workDir / "libraries" / name).string();
+        job.expectedSize = options.batchFileSize;
+        jobs.push_back(job);
+    }
+
+    server.takeServiceTimes();
+    for (int run = 0; run < options.batchRuns; ++run) {
+        std::error_code ec;
+        fs::remove_all(workDir / "libraries", ec);
+
+        const auto start = std::chrono::steady_clock::now();
+        const DownloadReport report = downloadBatch(jobs, options.batchConcurrency);
+        result.seconds += secondsSince(start);
+        result.requests += jobs.size();
+        result.failures += report.failed;
+        result.bytes += report.bytesDownloaded;
+    }
+    // Per-file latency is not visible through downloadBatch; the stand-in times each request instead
+    result.latenciesMs = server.takeServiceTimes();
+    return result;
+}
+
+json resultJson(const ScenarioResult& result) {
+    return {
+        {"scenario", result.name},
+        {"requests", result.requests},
+        {"failures", result.failures},
+        {"bytes", result.bytes},
+        {"seconds", result.seconds},
+        {"mb_per_second", result.seconds > 0 ? result.bytes / (1024.0 * 1024.0) / result.seconds : 0.0},
+        {"requests_per_second", result.seconds > 0 ? result.requests / result.seconds : 0.0},
+        {"p50_ms", percentile(result.latenciesMs, 0.50)},
+        {"p99_ms", percentile(result.latenciesMs, 0.99)},
+        {"latency_source", result.latencySource}
+    };
+}
+
+void printTable(std::ostream& out, const std::vector<ScenarioResult>& results) {
+    out << std::left << std::setw(16) << "scenario" << std::right << std::setw(10) << "requests" << std::setw(8)
+        << "failed" << std::setw(12) << "MB/s" << std::setw(12) << "req/s" << std::setw(12) << "p50 ms"
+        << std::setw(12) << "p99 ms" << "\n";
+    for (const auto& result : results) {
+        const json row = resultJson(result);
+        out << std::left << std::setw(16) << result.name << std::right << std::setw(10) << result.requests
+            << std::setw(8) << result.failures << std::fixed << std::setprecision(2)
+            << std::setw(12) << row["mb_per_second"].get<double>()
+            << std::setw(12) << row["requests_per_second"].get<double>()
+            << std::setw(12) << row["p50_ms"].get<double>()
+            << std::setw(12) << row["p99_ms"].get<double>()
+            << "  (" << result.latencySource << " latency)\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    HttpStandin server(options.server);
+    server.addBody("/api/status.json", R"({"status":"ok","version":"1.0.0","message":"benchmark"})");
+    server.addFile("/files/large.bin", options.fileSize);
+    for (size_t i = 0; i < options.batchCount; ++i) {
+        server.addFile("/libraries/lib" + std::to_string(i) + ".jar", options.batchFileSize);
+    }
+    if (!server.start()) {
+        std::cerr << "Failed to start the local HTTP stand-in" << std::endl;
+        return 1;
+    }
+
+    // Scratch directory; also keeps http_cache.json and friends out of the caller's tree
+    const fs::path workDir = fs::temp_directory_path() / ("purr-download-bench-" + std::to_string(getpid()));
+    std::error_code ec;
+    fs::create_directories(workDir, ec);
+    const fs::path previousDir = fs::current_path();
+    fs::current_path(workDir, ec);
+    if (ec) {
+        std::cerr << "Failed to create " << workDir << ": " << ec.message() << std::endl;
+        return 1;
+    }
+
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    // The download code reports to std::cout; keep it off the results unless asked for
+    std::ostream out(std::cout.rdbuf());
+    std::ostringstream discarded;
+    if (!options.verbose) std::cout.rdbuf(discarded.rdbuf());
+
+    std::vector<ScenarioResult> results;
+    if (options.gets > 0) results.push_back(benchGet(server, options));
+    if (options.fileRuns > 0) results.push_back(benchFile(server, options, workDir));
+    if (options.batchRuns > 0 && options.batchCount > 0) results.push_back(benchBatch(server, options, workDir));
+
+    ProgressTracker::getInstance().shutdown();
+    HttpClient::getInstance().shutdown();
+    std::cout.rdbuf(out.rdbuf());
+    curl_global_cleanup();
+    server.stop();
+
+    fs::current_path(previousDir, ec);
+    fs::remove_all(workDir, ec);
+
+    size_t failures = 0;
+    for (const auto& result : results) failures += result.failures;
+
+    if (options.jsonOutput) {
+        json report = {
+            {"server", {
+                {"latency_ms", options.server.latency.count()},
+                {"bandwidth_bytes_per_second", options.server.bandwidthBytesPerSecond},
+                {"ranges", options.server.ranges},
+                {"chunked", options.server.chunked},
+                {"connections", server.totalConnections()}
+            }},
+            {"results", json::array()}
+        };
+        for (const auto& result : results) report["results"].push_back(resultJson(result));
+        out << report.dump(2) << std::endl;
+    } else {
+        printTable(out, results);
+        out << "Server: " << server.totalConnections() << " connection(s), "
+            << std::fixed << std::setprecision(1) << (server.totalBytes() / (1024.0 * 1024.0)) << " MB served" << std::endl;
+    }
+
+    // Any failed request makes the numbers meaningless for gating
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,573 @@
+// Extraction benchmark: generates synthetic zip and tar archives (file count, size
+// distribution, compressibility, stored or deflated) and extracts them with every
+// extractor backend, reporting MB/s, files/s and peak RSS. Each run happens in a forked
+// child so its peak RSS is its own. Every combination also runs once per small-file write
+// backend, with the syscalls each one issued and the wall time it saved over direct writes.
+#include "archive.h"
+#include "bulk_writer.h"
+
+#include <nlohmann/json.hpp>
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+
+enum class SizeDistribution { Fixed, Uniform, Exponential };
+
+struct BenchOptions {
+    size_t fileCount = 2000;
+    std::uint64_t meanFileSize = 64 * 1024;
+    SizeDistribution distribution = SizeDistribution::Exponential;
+    double compressibility = 0.5;  // Share of every file that is repetitive text
+    std::vector<std::string> methods = {"stored", "deflate"};
+    std::vector<std::string> backends = {"zip-reader", "zip-stream", "tar-stream"};
+    std::vector<BulkWriteBackend> writers = {BulkWriteBackend::Direct, BulkWriteBackend::ThreadPool,
+                                             BulkWriteBackend::IoUring};
+    size_t threads = 0;  // ZipReader workers, 0 for all cores
+    int runs = 3;
+    bool jsonOutput = false;
+};
+
+struct RunResult {
+    bool ok = false;
+    double seconds = 0.0;
+    std::uint64_t files = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t syscalls = 0;  // Small-file writes only
+    std::uint64_t smallFiles = 0;
+    char error[256] = {};
+};
+
+struct BackendResult {
+    std::string backend;
+    std::string method;
+    BulkWriteBackend writer = BulkWriteBackend::Direct;
+    std::uint64_t archiveBytes = 0;
+    std::uint64_t files = 0;
+    std::uint64_t bytes = 0;
+    double seconds = 0.0;  // Best run
+    long peakRssKb = 0;    // Largest of all runs
+    std::uint64_t syscalls = 0;      // Of the best run
+    std::uint64_t smallFiles = 0;
+    double secondsSaved = 0.0;       // Against the direct writer, same backend and method
+    bool hasBaseline = false;
+    int failures = 0;
+    std::string error;
+};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --files N             Files per archive (default 2000)\n"
+              << "  --size-kb N           Mean file size (default 64)\n"
+              << "  --distribution D      fixed, uniform or exponential (default exponential)\n"
+              << "  --compressibility F   0 = random bytes, 1 = all text (default 0.5)\n"
+              << "  --method M            stored or deflate, repeatable (default both)\n"
+              << "  --backend B           zip-reader, zip-stream or tar-stream, repeatable (default all)\n"
+              << "  --writer W            Small-file writer: direct, thread-pool or io-uring, repeatable\n"
+              << "                        (default all; io-uring only where the kernel supports it)\n"
+              << "  --threads N           ZipReader workers, 0 for all cores (default 0)\n"
+              << "  --runs N              Runs per backend and method, best is reported (default 3)\n"
+              << "  --json                Print results as JSON\n";
+}
+
+bool parseOptions(int argc, char** argv, BenchOptions& options) {
+    bool customMethods = false;
+    bool customBackends = false;
+    bool customWriters = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        double value = 0;
+        std::string text;
+        auto next = [&]() {
+            if (i + 1 >= argc) return false;
+            text = argv[++i];
+            try {
+                value = std::stod(text);
+            } catch (const std::exception&) {
+                value = -1;
+            }
+            return true;
+        };
+
+        if (arg == "--json") {
+            options.jsonOutput = true;
+        } else if (arg == "--files" && next() && value >= 1) {
+            options.fileCount = static_cast<size_t>(value);
+        } else if (arg == "--size-kb" && next() && value >= 0) {
+            options.meanFileSize = static_cast<std::uint64_t>(value * 1024);
+        } else if (arg == "--distribution" && next()) {
+            if (text == "fixed") options.distribution = SizeDistribution::Fixed;
+            else if (text == "uniform") options.distribution = SizeDistribution::Uniform;
+            else if (text == "exponential") options.distribution = SizeDistribution::Exponential;
+            else return false;
+        } else if (arg == "--compressibility" && next() && value >= 0 && value <= 1) {
+            options.compressibility = value;
+        } else if (arg == "--method" && next() && (text == "stored" || text == "deflate")) {
+            if (!customMethods) options.methods.clear();
+            customMethods = true;
+            options.methods.push_back(text);
+        } else if (arg == "--backend" && next() &&
+                   (text == "zip-reader" || text == "zip-stream" || text == "tar-stream")) {
+            if (!customBackends) options.backends.clear();
+            customBackends = true;
+            options.backends.push_back(text);
+        } else if (arg == "--writer" && next() &&
+                   (text == "direct" || text == "thread-pool" || text == "io-uring")) {
+            if (!customWriters) options.writers.clear();
+            customWriters = true;
+            options.writers.push_back(text == "direct" ? BulkWriteBackend::Direct
+                                      : text == "thread-pool" ? BulkWriteBackend::ThreadPool
+                                      : BulkWriteBackend::IoUring);
+        } else if (arg == "--threads" && next() && value >= 0) {
+            options.threads = static_cast<size_t>(value);
+        } else if (arg == "--runs" && next() && value >= 1) {
+            options.runs = static_cast<int>(value);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Deterministic file contents: a run of text that deflate shrinks well, then random bytes
+class ContentGenerator {
+private:
+    std::mt19937_64 rng{42};
+    const BenchOptions& options;
+
+public:
+    explicit ContentGenerator(const BenchOptions& benchOptions) : options(benchOptions) {}
+
+    std::uint64_t nextSize() {
+        const double mean = static_cast<double>(options.meanFileSize);
+        switch (options.distribution) {
+            case SizeDistribution::Fixed:
+                return options.meanFileSize;
+            case SizeDistribution::Uniform:
+                return std::uniform_int_distribution<std::uint64_t>(0, options.meanFileSize * 2)(rng);
+            case SizeDistribution::Exponential:
+                // Many small files and a long tail of big ones, like a modpack's configs and jars
+                return mean > 0 ? static_cast<std::uint64_t>(std::exponential_distribution<double>(1.0 / mean)(rng)) : 0;
+        }
+        return options.meanFileSize;
+    }
+
+    void fill(std::vector<char>& data, std::uint64_t size) {
+        static const char* words[] = {"minecraft", "config", "option", "true", "false", "render", "distance",
+                                      "texture", "block", "entity", "=", "\n", " ", "[general]", "0.5"};
+        data.resize(size);
+        const size_t text = static_cast<size_t>(static_cast<double>(size) * options.compressibility);
+        size_t offset = 0;
+        while (offset < text) {
+            const char* word = words[rng() % std::size(words)];
+            const size_t count = std::min(std::strlen(word), text - offset);
+            std::memcpy(data.data() + offset, word, count);
+            offset += count;
+        }
+        for (; offset + 8 <= size; offset += 8) {
+            const std::uint64_t bits = rng();
+            std::memcpy(data.data() + offset, &bits, 8);
+        }
+        for (; offset < size; ++offset) data[offset] = static_cast<char>(rng());
+    }
+};
+
+void putLE16(std::string& out, std::uint16_t value) {
+    out.push_back(static_cast<char>(value & 0xFF));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+void putLE32(std::string& out, std::uint32_t value) {
+    putLE16(out, static_cast<std::uint16_t>(value & 0xFFFF));
+    putLE16(out, static_cast<std::uint16_t>(value >> 16));
+}
+
+// Raw deflate of a whole file, as stored in a zip entry
+bool deflateBuffer(const std::vector<char>& data, std::vector<char>& out) {
+    z_stream z = {};
+    if (deflateInit2(&z, 6, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+    out.resize(deflateBound(&z, static_cast<uLong>(data.size())));
+    z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    z.avail_in = static_cast<uInt>(data.size());
+    z.next_out = reinterpret_cast<Bytef*>(out.data());
+    z.avail_out = static_cast<uInt>(out.size());
+    const bool ok = deflate(&z, Z_FINISH) == Z_STREAM_END;
+    out.resize(out.size() - z.avail_out);
+    deflateEnd(&z);
+    return ok;
+}
+
+std::string entryName(size_t index) {
+    return "dir" + std::to_string(index / 100) + "/file" + std::to_string(index) + ".dat";
+}
+
+// Zip with every entry stored or deflated; sizes are known up front, so no data descriptors
+bool writeZip(const fs::path& path, const BenchOptions& options, bool deflated) {
+    std::ofstream out(path, std::ios::binary);
+    ContentGenerator generator(options);
+    std::string central;
+    std::uint64_t offset = 0;
+    std::vector<char> data, compressed;
+
+    for (size_t i = 0; i < options.fileCount; ++i) {
+        const std::string name = entryName(i);
+        generator.fill(data, generator.nextSize());
+        const std::uint32_t crc = static_cast<std::uint32_t>(
+            ::crc32(0, reinterpret_cast<const Bytef*>(data.data()), static_cast<uInt>(data.size())));
+        if (deflated && !deflateBuffer(data, compressed)) return false;
+        const std::vector<char>& stored = deflated ? compressed : data;
+        if (offset + stored.size() + 1024 > 0xFFFFFFFFull) {
+            std::cerr << "Synthetic zip would need zip64; use fewer or smaller files" << std::endl;
+            return false;
+        }
+
+        std::string header;
+        putLE32(header, 0x04034b50);
+        putLE16(header, 20);
+        putLE16(header, 0);
+        putLE16(header, deflated ? 8 : 0);
+        putLE32(header, 0);  // DOS time and date
+        putLE32(header, crc);
+        putLE32(header, static_cast<std::uint32_t>(stored.size()));
+        putLE32(header, static_cast<std::uint32_t>(data.size()));
+        putLE16(header, static_cast<std::uint16_t>(name.size()));
+        putLE16(header, 0);
+        header += name;
+
+        putLE32(central, 0x02014b50);
+        putLE16(central, (3 << 8) | 20);  // Made by Unix
+        putLE16(central, 20);
+        putLE16(central, 0);
+        putLE16(central, deflated ? 8 : 0);
+        putLE32(central, 0);
+        putLE32(central, crc);
+        putLE32(central, static_cast<std::uint32_t>(stored.size()));
+        putLE32(central, static_cast<std::uint32_t>(data.size()));
+        putLE16(central, static_cast<std::uint16_t>(name.size()));
+        putLE16(central, 0);
+        putLE16(central, 0);
+        putLE16(central, 0);
+        putLE16(central, 0);
+        putLE32(central, 0100644u << 16);
+        putLE32(central, static_cast<std::uint32_t>(offset));
+        central += name;
+
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+        out.write(stored.data(), static_cast<std::streamsize>(stored.size()));
+        offset += header.size() + stored.size();
+    }
+
+    const size_t entries = std::min<size_t>(options.fileCount, 0xFFFF);
+    if (entries != options.fileCount) {
+        std::cerr << "Synthetic zip would need zip64; use at most 65535 files" << std::endl;
+        return false;
+    }
+    std::string end;
+    putLE32(end, 0x06054b50);
+    putLE32(end, 0);
+    putLE16(end, static_cast<std::uint16_t>(entries));
+    putLE16(end, static_cast<std::uint16_t>(entries));
+    putLE32(end, static_cast<std::uint32_t>(central.size()));
+    putLE32(end, static_cast<std::uint32_t>(offset));
+    putLE16(end, 0);
+    out.write(central.data(), static_cast<std::streamsize>(central.size()));
+    out.write(end.data(), static_cast<std::streamsize>(end.size()));
+    return static_cast<bool>(out);
+}
+
+// ustar archive with the same files; gzip-compressed for "deflate", plain for "stored"
+bool writeTar(const fs::path& path, const BenchOptions& options, bool gzip) {
+    std::ofstream out(path, std::ios::binary);
+    z_stream z = {};
+    if (gzip && deflateInit2(&z, 6, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+    std::vector<char> chunk(256 * 1024);
+    auto emit = [&](const char* data, size_t length, int flush) {
+        if (!gzip) {
+            out.write(data, static_cast<std::streamsize>(length));
+            return true;
+        }
+        z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        z.avail_in = static_cast<uInt>(length);
+        do {
+            z.next_out = reinterpret_cast<Bytef*>(chunk.data());
+            z.avail_out = static_cast<uInt>(chunk.size());
+            if (deflate(&z, flush) == Z_STREAM_ERROR) return false;
+            out.write(chunk.data(), static_cast<std::streamsize>(chunk.size() - z.avail_out));
+        } while (z.avail_out == 0);
+        return true;
+    };
+
+    ContentGenerator generator(options);
+    std::vector<char> data;
+    bool ok = true;
+    for (size_t i = 0; ok && i < options.fileCount; ++i) {
+        const std::string name = entryName(i);
+        generator.fill(data, generator.nextSize());
+
+        char header[512] = {};
+        std::snprintf(header, 100, "%s", name.c_str());
+        std::snprintf(header + 100, 8, "%07o", 0644);
+        std::snprintf(header + 108, 8, "%07o", 0);
+        std::snprintf(header + 116, 8, "%07o", 0);
+        std::snprintf(header + 124, 12, "%011llo", static_cast<unsigned long long>(data.size()));
+        std::snprintf(header + 136, 12, "%011o", 0);
+        header[156] = '0';
+        std::memcpy(header + 257, "ustar", 6);
+        std::memcpy(header + 263, "00", 2);
+        std::memset(header + 148, ' ', 8);
+        unsigned sum = 0;
+        for (unsigned char c : header) sum += c;
+        std::snprintf(header + 148, 8, "%06o", sum);
+
+        data.resize((data.size() + 511) / 512 * 512, '\0');
+        ok = emit(header, sizeof(header), Z_NO_FLUSH) && emit(data.data(), data.size(), Z_NO_FLUSH);
+    }
+    const std::vector<char> trailer(1024, '\0');
+    ok = ok && emit(trailer.data(), trailer.size(), Z_FINISH);
+    if (gzip) deflateEnd(&z);
+    return ok && static_cast<bool>(out);
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs in the child process
+RunResult extractOnce(const std::string& backend, const fs::path& archive, const fs::path& outputDir,
+                      const BenchOptions& options) {
+    RunResult result;
+    std::string error;
+    resetBulkWriteStats();
+    const auto start = std::chrono::steady_clock::now();
+
+    if (backend == "zip-reader") {
+        ZipReader reader;
+        result.ok = reader.open(archive.string()) && reader.extract(outputDir.string(), nullptr, options.threads);
+        result.files = reader.filesExtracted();
+        result.bytes = reader.bytesExtracted();
+        error = reader.error();
+    } else {
+        // Streaming backends read the file front to back, as they would read a download
+        ZipStreamExtractor zip(outputDir.string());
+        TarStreamExtractor tar(outputDir.string());
+        const bool isZip = backend == "zip-stream";
+        std::ifstream in(archive, std::ios::binary);
+        std::vector<char> buffer(1024 * 1024);
+        result.ok = isZip ? zip.reset() : tar.reset();
+        while (result.ok && in) {
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            const size_t count = static_cast<size_t>(in.gcount());
+            if (count > 0) result.ok = isZip ? zip.feed(buffer.data(), count) : tar.feed(buffer.data(), count);
+        }
+        result.ok = result.ok && (isZip ? zip.finish() : tar.finish());
+        result.files = isZip ? zip.entriesExtracted() : tar.entriesExtracted();
+        result.bytes = isZip ? zip.bytesExtracted() : tar.bytesExtracted();
+        error = isZip ? zip.error() : tar.error();
+    }
+
+    result.seconds = secondsSince(start);
+    const BulkWriteStats stats = bulkWriteStats();
+    result.syscalls = stats.syscalls;
+    result.smallFiles = stats.files;
+    std::snprintf(result.error, sizeof(result.error), "%s", error.c_str());
+    return result;
+}
+
+// Fork, extract in the child, and collect its timing and peak RSS
+bool runInChild(const std::string& backend, BulkWriteBackend writer, const fs::path& archive,
+                const fs::path& outputDir, const BenchOptions& options, RunResult& result, long& peakRssKb) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    std::cout.flush();
+
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        setBulkWriteBackend(writer);
+        const RunResult child = extractOnce(backend, archive, outputDir, options);
+        const bool written = write(fds[1], &child, sizeof(child)) == static_cast<ssize_t>(sizeof(child));
+        _exit(written ? 0 : 1);
+    }
+
+    close(fds[1]);
+    const bool received = read(fds[0], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    rusage usage = {};
+    wait4(pid, &status, 0, &usage);
+    peakRssKb = usage.ru_maxrss;
+    return received && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+json resultJson(const BackendResult& result) {
+    return {
+        {"backend", result.backend},
+        {"method", result.method},
+        {"archive_bytes", result.archiveBytes},
+        {"files", result.files},
+        {"bytes", result.bytes},
+        {"seconds", result.seconds},
+        {"mb_per_second", result.seconds > 0 ? result.bytes / (1024.0 * 1024.0) / result.seconds : 0.0},
+        {"files_per_second", result.seconds > 0 ? result.files / result.seconds : 0.0},
+        {"peak_rss_kb", result.peakRssKb},
+        {"writer", bulkWriteBackendName(result.writer)},
+        {"small_files", result.smallFiles},
+        {"writer_syscalls", result.syscalls},
+        {"seconds_saved_vs_direct", result.hasBaseline ? json(result.secondsSaved) : json(nullptr)},
+        {"failures", result.failures}
+    };
+}
+
+void printTable(std::ostream& out, const std::vector<BackendResult>& results) {
+    out << std::left << std::setw(12) << "backend" << std::setw(9) << "method" << std::setw(13) << "writer"
+        << std::right << std::setw(8) << "files" << std::setw(10) << "MB" << std::setw(10) << "MB/s"
+        << std::setw(11) << "files/s" << std::setw(13) << "peak RSS MB" << std::setw(10) << "syscalls"
+        << std::setw(10) << "saved ms" << std::setw(8) << "failed" << "\n";
+    for (const auto& result : results) {
+        const json row = resultJson(result);
+        std::ostringstream saved;
+        if (result.hasBaseline) saved << std::fixed << std::setprecision(1) << result.secondsSaved * 1000.0;
+        out << std::left << std::setw(12) << result.backend << std::setw(9) << result.method
+            << std::setw(13) << bulkWriteBackendName(result.writer) << std::right
+            << std::setw(8) << result.files << std::fixed << std::setprecision(1)
+            << std::setw(10) << result.bytes / (1024.0 * 1024.0)
+            << std::setw(10) << row["mb_per_second"].get<double>()
+            << std::setw(11) << row["files_per_second"].get<double>()
+            << std::setw(13) << result.peakRssKb / 1024.0
+            << std::setw(10) << result.syscalls
+            << std::setw(10) << (result.hasBaseline ? saved.str() : "-")
+            << std::setw(8) << result.failures << "\n";
+        if (!result.error.empty()) out << "  " << result.error << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    const fs::path workDir = fs::temp_directory_path() / ("purr-extract-bench-" + std::to_string(getpid()));
+    std::error_code ec;
+    fs::create_directories(workDir, ec);
+    if (ec) {
+        std::cerr << "Failed to create " << workDir << ": " << ec.message() << std::endl;
+        return 1;
+    }
+
+    if (std::find(options.writers.begin(), options.writers.end(), BulkWriteBackend::IoUring) != options.writers.end() &&
+        !ioUringAvailable()) {
+        std::cerr << "io_uring is not available (kernel or build); skipping the io-uring writer" << std::endl;
+        options.writers.erase(std::remove(options.writers.begin(), options.writers.end(), BulkWriteBackend::IoUring),
+                              options.writers.end());
+    }
+
+    std::vector<BackendResult> results;
+    int failures = 0;
+    for (const auto& method : options.methods) {
+        const bool deflated = method == "deflate";
+        const fs::path zipPath = workDir / (method + ".zip");
+        const fs::path tarPath = workDir / (deflated ? "deflate.tar.gz" : "stored.tar");
+        if (!writeZip(zipPath, options, deflated) || !writeTar(tarPath, options, deflated)) {
+            std::cerr << "Failed to generate the " << method << " archives" << std::endl;
+            fs::remove_all(workDir, ec);
+            return 1;
+        }
+
+        for (const auto& backend : options.backends) {
+            for (BulkWriteBackend writer : options.writers) {
+                BackendResult row;
+                row.backend = backend;
+                row.method = method;
+                row.writer = writer;
+                const fs::path archive = backend == "tar-stream" ? tarPath : zipPath;
+                row.archiveBytes = fs::file_size(archive, ec);
+
+                for (int run = 0; run < options.runs; ++run) {
+                    const fs::path outputDir = workDir / "out";
+                    fs::remove_all(outputDir, ec);  // Not timed
+
+                    RunResult result;
+                    long peakRssKb = 0;
+                    const bool finished = runInChild(backend, writer, archive, outputDir, options, result, peakRssKb);
+                    row.peakRssKb = std::max(row.peakRssKb, peakRssKb);
+                    if (!finished || !result.ok || result.files != options.fileCount) {
+                        ++row.failures;
+                        row.error = finished ? result.error : "child process failed";
+                        if (row.error.empty()) row.error = "extracted " + std::to_string(result.files) + " files";
+                        continue;
+                    }
+                    if (row.seconds == 0.0 || result.seconds < row.seconds) {
+                        row.seconds = result.seconds;
+                        row.files = result.files;
+                        row.bytes = result.bytes;
+                        row.syscalls = result.syscalls;
+                        row.smallFiles = result.smallFiles;
+                    }
+                }
+                failures += row.failures;
+                results.push_back(row);
+            }
+        }
+    }
+
+    // Time saved by each writer against direct writes of the same backend and archive
+    for (auto& row : results) {
+        for (const auto& baseline : results) {
+            if (baseline.writer == BulkWriteBackend::Direct && baseline.backend == row.backend &&
+                baseline.method == row.method && baseline.failures == 0 && row.failures == 0) {
+                row.secondsSaved = baseline.seconds - row.seconds;
+                row.hasBaseline = true;
+            }
+        }
+    }
+    fs::remove_all(workDir, ec);
+
+    if (options.jsonOutput) {
+        static const char* distributions[] = {"fixed", "uniform", "exponential"};
+        json report = {
+            {"archive", {
+                {"files", options.fileCount},
+                {"mean_file_bytes", options.meanFileSize},
+                {"distribution", distributions[static_cast<int>(options.distribution)]},
+                {"compressibility", options.compressibility}
+            }},
+            {"threads", options.threads},
+            {"runs", options.runs},
+            {"results", json::array()}
+        };
+        for (const auto& result : results) report["results"].push_back(resultJson(result));
+        std::cout << report.dump(2) << std::endl;
+    } else {
+        printTable(std::cout, results);
+        std::cout << "Best of " << options.runs << " run(s); peak RSS is the largest child process seen" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
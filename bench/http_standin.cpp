@@ -0,0 +1,327 @@
+#include "http_standin.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <sstream>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t PATTERN_SIZE = 1 << 20;
+constexpr size_t SEND_SLICE = 64 * 1024;
+constexpr size_t MAX_HEADER_BYTES = 64 * 1024;
+
+std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+std::string trim(const std::string& text) {
+    const size_t first = text.find_first_not_of(" \t");
+    if (first == std::string::npos) return "";
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+// "bytes=a-b", "bytes=a-" or "bytes=-n" against a body of size; false when unsatisfiable
+bool parseRange(const std::string& value, std::uint64_t size, std::uint64_t& first, std::uint64_t& last) {
+    if (value.rfind("bytes=", 0) != 0 || value.find(',') != std::string::npos || size == 0) return false;
+    const std::string spec = value.substr(6);
+    const size_t dash = spec.find('-');
+    if (dash == std::string::npos) return false;
+    try {
+        if (dash == 0) {
+            const std::uint64_t suffix = std::stoull(spec.substr(1));
+            if (suffix == 0) return false;
+            first = size - std::min(suffix, size);
+            last = size - 1;
+        } else {
+            first = std::stoull(spec.substr(0, dash));
+            last = dash + 1 < spec.size() ? std::min<std::uint64_t>(std::stoull(spec.substr(dash + 1)), size - 1) : size - 1;
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    return first <= last && first < size;
+}
+
+} // namespace
+
+HttpStandin::HttpStandin(const StandinOptions& standinOptions) : options(standinOptions), pattern(PATTERN_SIZE) {
+    // Incompressible, so results do not depend on transfer encoding
+    std::mt19937 generator(20240601);
+    for (char& byte : pattern) byte = static_cast<char>(generator() & 0xff);
+}
+
+HttpStandin::~HttpStandin() {
+    stop();
+}
+
+void HttpStandin::addFile(const std::string& path, std::uint64_t size) {
+    Resource resource;
+    resource.size = size;
+    resource.seed = static_cast<std::uint32_t>(std::hash<std::string>{}(path) % PATTERN_SIZE);
+    resources[path] = resource;
+}
+
+void HttpStandin::addBody(const std::string& path, const std::string& body) {
+    Resource resource;
+    resource.size = body.size();
+    resource.body = body;
+    resource.verbatim = true;
+    resources[path] = resource;
+}
+
+bool HttpStandin::start() {
+    listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) return false;
+
+    const int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t addressLength = sizeof(address);
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 256) != 0 ||
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &addressLength) != 0) {
+        ::close(listener);
+        listener = -1;
+        return false;
+    }
+    boundPort = ntohs(address.sin_port);
+
+    running = true;
+    acceptThread = std::thread(&HttpStandin::acceptLoop, this);
+    return true;
+}
+
+void HttpStandin::stop() {
+    if (!running.exchange(false)) return;
+
+    // Unblock accept() and every recv()/send() so the threads notice
+    ::shutdown(listener, SHUT_RDWR);
+    ::close(listener);
+    listener = -1;
+    if (acceptThread.joinable()) acceptThread.join();
+
+    std::vector<std::thread> finished;
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        for (int socket : sockets) ::shutdown(socket, SHUT_RDWR);
+        finished.swap(workers);
+    }
+    for (auto& worker : finished) worker.join();
+}
+
+std::string HttpStandin::url(const std::string& path) const {
+    return "http://127.0.0.1:" + std::to_string(boundPort) + path;
+}
+
+std::vector<double> HttpStandin::takeServiceTimes() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    std::vector<double> times;
+    times.swap(serviceTimes);
+    return times;
+}
+
+std::uint64_t HttpStandin::totalBytes() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return bytesServed;
+}
+
+size_t HttpStandin::totalConnections() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return connectionCount;
+}
+
+void HttpStandin::acceptLoop() {
+    while (running) {
+        const int socket = ::accept(listener, nullptr, nullptr);
+        if (socket < 0) {
+            if (!running) return;
+            continue;
+        }
+        const int yes = 1;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        if (!running) {
+            ::close(socket);
+            return;
+        }
+        sockets.push_back(socket);
+        workers.emplace_back(&HttpStandin::serve, this, socket);
+        std::lock_guard<std::mutex> statsLock(statsMutex);
+        ++connectionCount;
+    }
+}
+
+void HttpStandin::serve(int socket) {
+    std::string buffer;
+    char chunk[16 * 1024];
+    bool keepAlive = true;
+
+    while (keepAlive && running) {
+        // Read one request head
+        size_t headEnd;
+        while ((headEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            const ssize_t received = ::recv(socket, chunk, sizeof(chunk), 0);
+            if (received <= 0 || buffer.size() > MAX_HEADER_BYTES) {
+                keepAlive = false;
+                break;
+            }
+            buffer.append(chunk, static_cast<size_t>(received));
+        }
+        if (!keepAlive) break;
+
+        std::istringstream head(buffer.substr(0, headEnd));
+        buffer.erase(0, headEnd + 4);
+
+        std::string requestLine, method, target, version;
+        std::getline(head, requestLine);
+        std::istringstream(requestLine) >> method >> target >> version;
+
+        std::map<std::string, std::string> headers;
+        for (std::string line; std::getline(head, line);) {
+            const size_t colon = line.find(':');
+            if (colon != std::string::npos) headers[lowercase(line.substr(0, colon))] = trim(line.substr(colon + 1));
+        }
+
+        // Drop a request body; nothing here looks at it
+        if (auto it = headers.find("content-length"); it != headers.end()) {
+            size_t remaining = 0;
+            try {
+                remaining = std::stoul(it->second);
+            } catch (const std::exception&) {}
+            while (buffer.size() < remaining) {
+                const ssize_t received = ::recv(socket, chunk, sizeof(chunk), 0);
+                if (received <= 0) break;
+                buffer.append(chunk, static_cast<size_t>(received));
+            }
+            buffer.erase(0, std::min(remaining, buffer.size()));
+        }
+
+        keepAlive = version == "HTTP/1.1" && lowercase(headers["connection"]) != "close";
+        const auto started = std::chrono::steady_clock::now();
+        if (!respond(socket, method, target.substr(0, target.find('?')), headers, keepAlive)) break;
+
+        const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        std::lock_guard<std::mutex> lock(statsMutex);
+        serviceTimes.push_back(elapsed);
+    }
+
+    std::lock_guard<std::mutex> lock(connectionMutex);
+    sockets.erase(std::remove(sockets.begin(), sockets.end(), socket), sockets.end());
+    ::close(socket);
+}
+
+bool HttpStandin::respond(int socket, const std::string& method, const std::string& path,
+                          const std::map<std::string, std::string>& headers, bool& keepAlive) {
+    if (options.latency.count() > 0) std::this_thread::sleep_for(options.latency);
+
+    std::ostringstream reply;
+    const auto it = resources.find(path);
+    if (it == resources.end() || (method != "GET" && method != "HEAD" && method != "POST")) {
+        const int status = it == resources.end() ? 404 : 405;
+        reply << "HTTP/1.1 " << status << (status == 404 ? " Not Found" : " Method Not Allowed") << "\r\n"
+              << "Content-Length: 0\r\n"
+              << (keepAlive ? "" : "Connection: close\r\n") << "\r\n";
+        const std::string text = reply.str();
+        return sendAll(socket, text.data(), text.size());
+    }
+
+    const Resource& resource = it->second;
+    std::uint64_t first = 0;
+    std::uint64_t last = resource.size == 0 ? 0 : resource.size - 1;
+    bool partial = false;
+
+    if (auto range = headers.find("range"); options.ranges && range != headers.end() && !resource.verbatim) {
+        if (!parseRange(range->second, resource.size, first, last)) {
+            reply << "HTTP/1.1 416 Range Not Satisfiable\r\n"
+                  << "Content-Range: bytes */" << resource.size << "\r\n"
+                  << "Content-Length: 0\r\n\r\n";
+            const std::string text = reply.str();
+            return sendAll(socket, text.data(), text.size());
+        }
+        partial = true;
+    }
+    const std::uint64_t length = resource.size == 0 ? 0 : last - first + 1;
+
+    reply << "HTTP/1.1 " << (partial ? "206 Partial Content" : "200 OK") << "\r\n";
+    reply << "Content-Type: " << (resource.verbatim ? "application/json" : "application/octet-stream") << "\r\n";
+    reply << "ETag: \"" << std::hex << resource.seed << '-' << resource.size << std::dec << "\"\r\n";
+    reply << "Last-Modified: Mon, 01 Jan 2024 00:00:00 GMT\r\n";
+    if (options.ranges && !resource.verbatim) reply << "Accept-Ranges: bytes\r\n";
+    if (partial) reply << "Content-Range: bytes " << first << '-' << last << '/' << resource.size << "\r\n";
+    if (options.chunked) {
+        reply << "Transfer-Encoding: chunked\r\n";
+    } else {
+        reply << "Content-Length: " << length << "\r\n";
+    }
+    if (!keepAlive) reply << "Connection: close\r\n";
+    reply << "\r\n";
+
+    const std::string text = reply.str();
+    if (!sendAll(socket, text.data(), text.size())) return false;
+    if (method == "HEAD") return true;
+    if (!sendBody(socket, resource, first, length)) return false;
+    if (options.chunked && !sendAll(socket, "0\r\n\r\n", 5)) return false;
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    bytesServed += length;
+    return true;
+}
+
+bool HttpStandin::sendBody(int socket, const Resource& resource, std::uint64_t first, std::uint64_t length) {
+    const auto started = std::chrono::steady_clock::now();
+    std::uint64_t sent = 0;
+
+    while (sent < length) {
+        const char* data;
+        size_t count;
+        if (resource.verbatim) {
+            data = resource.body.data() + first + sent;
+            count = static_cast<size_t>(std::min<std::uint64_t>(length - sent, SEND_SLICE));
+        } else {
+            const size_t offset = static_cast<size_t>((first + sent + resource.seed) % PATTERN_SIZE);
+            data = pattern.data() + offset;
+            count = static_cast<size_t>(std::min<std::uint64_t>({length - sent, SEND_SLICE, PATTERN_SIZE - offset}));
+        }
+
+        if (options.chunked) {
+            char size[32];
+            const int prefix = std::snprintf(size, sizeof(size), "%zx\r\n", count);
+            if (!sendAll(socket, size, static_cast<size_t>(prefix))) return false;
+        }
+        if (!sendAll(socket, data, count)) return false;
+        if (options.chunked && !sendAll(socket, "\r\n", 2)) return false;
+        sent += count;
+
+        // Pace to the bandwidth cap: never ahead of where the cap says this connection may be
+        if (options.bandwidthBytesPerSecond > 0) {
+            const auto due = started + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(static_cast<double>(sent) / static_cast<double>(options.bandwidthBytesPerSecond)));
+            std::this_thread::sleep_until(due);
+        }
+    }
+    return true;
+}
+
+bool HttpStandin::sendAll(int socket, const char* data, size_t length) {
+    while (length > 0) {
+        const ssize_t written = ::send(socket, data, length, MSG_NOSIGNAL);
+        if (written <= 0) return false;
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef HTTP_STANDIN_H
+#define HTTP_STANDIN_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// How the stand-in behaves on every connection
+struct StandinOptions {
+    std::chrono::milliseconds latency{0};       // Added before the headers of every response
+    std::uint64_t bandwidthBytesPerSecond = 0;  // Per connection, 0 for unlimited
+    bool ranges = true;                         // Honour Range and advertise Accept-Ranges
+    bool chunked = false;                       // Send bodies chunked, without Content-Length
+};
+
+// Minimal HTTP/1.1 server on 127.0.0.1 standing in for the launcher's hosts, so download
+// benchmarks run offline and reproducibly. Files are synthetic (deterministic bytes of a
+// given size); small bodies such as API replies can be registered verbatim. One thread
+// per connection, keep-alive, single byte ranges, GET/HEAD/POST.
+class HttpStandin {
+private:
+    struct Resource {
+        std::uint64_t size = 0;
+        std::uint32_t seed = 0;
+        std::string body;  // Served verbatim when set
+        bool verbatim = false;
+    };
+
+    StandinOptions options;
+    std::map<std::string, Resource> resources;
+    std::vector<char> pattern;  // Source of synthetic file bytes
+
+    int listener = -1;
+    std::uint16_t boundPort = 0;
+    std::thread acceptThread;
+    std::atomic<bool> running{false};
+
+    std::mutex connectionMutex;
+    std::vector<int> sockets;
+    std::vector<std::thread> workers;
+
+    std::mutex statsMutex;
+    std::vector<double> serviceTimes;  // Milliseconds from request to last byte
+    std::uint64_t bytesServed = 0;
+    size_t connectionCount = 0;
+
+    void acceptLoop();
+    void serve(int socket);
+    bool respond(int socket, const std::string& method, const std::string& path,
+                 const std::map<std::string, std::string>& headers, bool& keepAlive);
+    bool sendBody(int socket, const Resource& resource, std::uint64_t first, std::uint64_t length);
+    bool sendAll(int socket, const char* data, size_t length);
+
+public:
+    explicit HttpStandin(const StandinOptions& standinOptions);
+    ~HttpStandin();
+
+    HttpStandin(const HttpStandin&) = delete;
+    HttpStandin& operator=(const HttpStandin&) = delete;
+
+    // Register before start()
+    void addFile(const std::string& path, std::uint64_t size);
+    void addBody(const std::string& path, const std::string& body);
+
+    // Listen on an ephemeral port of 127.0.0.1
+    bool start();
+    void stop();
+
+    std::string url(const std::string& path) const;
+
+    // Service times recorded since the last call, in milliseconds
+    std::vector<double> takeServiceTimes();
+
+    std::uint64_t totalBytes();
+    size_t totalConnections();
+};
+
+#endif // HTTP_STANDIN_H
@@ -0,0 +1,520 @@
+#include "include/bulk_writer.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(PURR_HAVE_IO_URING)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#endif
+
+static std::atomic<BulkWriteBackend> preferredBackend{BulkWriteBackend::Auto};
+static std::atomic<std::uint64_t> statFiles{0};
+static std::atomic<std::uint64_t> statBytes{0};
+static std::atomic<std::uint64_t> statSyscalls{0};
+
+const char* bulkWriteBackendName(BulkWriteBackend backend) {
+    switch (backend) {
+        case BulkWriteBackend::Auto: return "auto";
+        case BulkWriteBackend::Direct: return "direct";
+        case BulkWriteBackend::ThreadPool: return "thread-pool";
+        case BulkWriteBackend::IoUring: return "io-uring";
+    }
+    return "unknown";
+}
+
+BulkWriteBackend bulkWriteBackend() {
+    return preferredBackend;
+}
+
+void setBulkWriteBackend(BulkWriteBackend backend) {
+    preferredBackend = backend;
+}
+
+BulkWriteStats bulkWriteStats() {
+    return {statFiles, statBytes, statSyscalls};
+}
+
+void resetBulkWriteStats() {
+    statFiles = 0;
+    statBytes = 0;
+    statSyscalls = 0;
+}
+
+struct BulkWriteJob {
+    std::string path;
+    std::vector<char> owned;  // Backing store when the caller handed its buffer over
+    const char* data = nullptr;
+    size_t length = 0;
+    std::uint32_t mode = 0644;
+};
+
+// One file with plain syscalls: unlink, open, write until done, close. An existing file is
+// unlinked rather than truncated, because it may be a hardlink whose other names keep its data.
+static bool writeWholeFile(const BulkWriteJob& job, std::string& error) {
+#ifdef _WIN32
+    if (!DeleteFileA(job.path.c_str()) && GetLastError() != ERROR_FILE_NOT_FOUND) {
+        ++statSyscalls;
+        error = "Failed to replace " + job.path;
+        return false;
+    }
+    HANDLE h = CreateFileA(job.path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+    statSyscalls += 3;  // Delete, create and close
+    if (h == INVALID_HANDLE_VALUE) {
+        error = "Failed to create " + job.path;
+        return false;
+    }
+    for (size_t done = 0; done < job.length;) {
+        DWORD written = 0;
+        const DWORD chunk = static_cast<DWORD>(std::min<size_t>(job.length - done, 1u << 30));
+        ++statSyscalls;
+        if (!WriteFile(h, job.data + done, chunk, &written, nullptr) || written == 0) {
+            CloseHandle(h);
+            error = "Failed to write " + job.path;
+            return false;
+        }
+        done += written;
+    }
+    if (!CloseHandle(h)) {
+        error = "Failed to write " + job.path;
+        return false;
+    }
+#else
+    if (::unlink(job.path.c_str()) != 0 && errno != ENOENT) {
+        ++statSyscalls;
+        error = "Failed to replace " + job.path + ": " + std::strerror(errno);
+        return false;
+    }
+    const int fd = ::open(job.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, static_cast<mode_t>(job.mode));
+    statSyscalls += 3;  // Unlink, open and close
+    if (fd < 0) {
+        error = "Failed to create " + job.path + ": " + std::strerror(errno);
+        return false;
+    }
+    for (size_t done = 0; done < job.length;) {
+        ++statSyscalls;
+        const ssize_t written = ::write(fd, job.data + done, job.length - done);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) {
+            error = "Failed to write " + job.path + ": " + std::strerror(written < 0 ? errno : ENOSPC);
+            ::close(fd);
+            return false;
+        }
+        done += static_cast<size_t>(written);
+    }
+    if (::close(fd) != 0) {
+        error = "Failed to write " + job.path + ": " + std::strerror(errno);
+        return false;
+    }
+#endif
+    return true;
+}
+
+struct BulkFileWriter::Backend {
+    std::string error;
+    bool failed = false;
+
+    virtual ~Backend() = default;
+    virtual BulkWriteBackend kind() const = 0;
+    virtual bool submit(BulkWriteJob job) = 0;
+    virtual bool flush() = 0;
+};
+
+struct BulkFileWriter::DirectBackend : BulkFileWriter::Backend {
+    BulkWriteBackend kind() const override { return BulkWriteBackend::Direct; }
+
+    bool submit(BulkWriteJob job) override {
+        if (!failed && !writeWholeFile(job, error)) failed = true;
+        return !failed;
+    }
+
+    bool flush() override { return !failed; }
+};
+
+struct BulkFileWriter::ThreadPoolBackend : BulkFileWriter::Backend {
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable spaceFree;
+    std::condition_variable idle;
+    std::deque<BulkWriteJob> queue;
+    size_t limit;
+    size_t active = 0;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+
+    ThreadPoolBackend(size_t threadCount, size_t queueDepth) : limit(queueDepth) {
+        for (size_t i = 0; i < threadCount; ++i) threads.emplace_back([this]() { run(); });
+    }
+
+    ~ThreadPoolBackend() override {
+        flush();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        workReady.notify_all();
+        for (auto& thread : threads) thread.join();
+    }
+
+    BulkWriteBackend kind() const override { return BulkWriteBackend::ThreadPool; }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            workReady.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            BulkWriteJob job = std::move(queue.front());
+            queue.pop_front();
+            ++active;
+            spaceFree.notify_one();
+
+            lock.unlock();
+            std::string message;
+            const bool ok = writeWholeFile(job, message);
+            lock.lock();
+
+            --active;
+            if (!ok && !failed) {
+                failed = true;
+                error = message;
+                spaceFree.notify_all();  // Let a blocked submit() see the failure
+            }
+            if (queue.empty() && active == 0) idle.notify_all();
+        }
+    }
+
+    bool submit(BulkWriteJob job) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        spaceFree.wait(lock, [this]() { return failed || queue.size() < limit; });
+        if (failed) return false;
+        queue.push_back(std::move(job));
+        workReady.notify_one();
+        return true;
+    }
+
+    bool flush() override {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return queue.empty() && active == 0; });
+        return !failed;
+    }
+};
+
+#if defined(__linux__) && defined(PURR_HAVE_IO_URING)
+// Raw io_uring without liburing. Every file becomes a hard-linked unlink -> open -> write -> close
+// chain on a registered (direct) descriptor slot, so no file descriptor ever reaches user space. Files are
+// submitted in batches; two batches are in flight at once so the caller fills one while the
+// kernel works through the other.
+struct BulkFileWriter::IoUringBackend : BulkFileWriter::Backend {
+    enum Op : std::uint64_t { Open = 0, Write = 1, Close = 2, Unlink = 3 };
+
+    struct Batch {
+        std::vector<BulkWriteJob> jobs;
+        unsigned expected = 0;   // Completions to wait for
+        unsigned completed = 0;
+        bool submitted = false;
+    };
+
+    int ringFd = -1;
+    void* ringMap = MAP_FAILED;
+    size_t ringMapSize = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqesSize = 0;
+    unsigned* sqTail = nullptr;
+    unsigned sqMask = 0;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+    size_t filesPerBatch = 0;
+    Batch batches[2];
+    int filling = 0;
+
+    ~IoUringBackend() override {
+        if (ringFd >= 0) flush();
+        if (sqes != MAP_FAILED) munmap(sqes, sqesSize);
+        if (ringMap != MAP_FAILED) munmap(ringMap, ringMapSize);
+        if (ringFd >= 0) ::close(ringFd);  // Also closes anything left in the descriptor table
+    }
+
+    BulkWriteBackend kind() const override { return BulkWriteBackend::IoUring; }
+
+    static int enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        ++statSyscalls;
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    // Direct descriptors (open into a registered slot, close by slot) arrived in 5.15. Older kernels
+    // take the same SQEs but ignore file_index, and no feature flag tells them apart.
+    static bool kernelHasDirectDescriptors() {
+        utsname name = {};
+        int major = 0;
+        int minor = 0;
+        if (uname(&name) != 0 || std::sscanf(name.release, "%d.%d", &major, &minor) != 2) return false;
+        return major > 5 || (major == 5 && minor >= 15);
+    }
+
+    // False when the kernel lacks io_uring, or is older than direct descriptors (5.15)
+    bool setup(size_t queueDepth) {
+        if (!kernelHasDirectDescriptors()) return false;
+
+        filesPerBatch = std::max<size_t>(queueDepth / 2, 1);
+        unsigned entries = 1;
+        while (entries < filesPerBatch * 4) entries <<= 1;  // One batch of chains at a time
+
+        io_uring_params params = {};
+        statSyscalls += 4;  // Setup, two mmaps, file registration
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ringFd < 0) return false;
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP) ||
+            params.cq_entries < filesPerBatch * 8) {
+            return false;
+        }
+
+        ringMapSize = std::max<size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                                       params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        ringMap = mmap(nullptr, ringMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                       IORING_OFF_SQ_RING);
+        if (ringMap == MAP_FAILED) return false;
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                               ringFd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) return false;
+
+        char* base = static_cast<char*>(ringMap);
+        sqTail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+
+        // Sparse descriptor table: one slot per file of both batches
+        std::vector<int> slots(filesPerBatch * 2, -1);
+        if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_FILES, slots.data(),
+                    static_cast<unsigned>(slots.size())) != 0) {
+            return false;
+        }
+        for (auto& batch : batches) batch.jobs.reserve(filesPerBatch);
+        return true;
+    }
+
+    io_uring_sqe* nextSqe(unsigned& tail, std::uint64_t userData) {
+        const unsigned index = tail & sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->user_data = userData;
+        sqArray[index] = index;
+        ++tail;
+        return sqe;
+    }
+
+    void fail(const std::string& message) {
+        if (failed) return;
+        failed = true;
+        error = message;
+    }
+
+    // Take every completion the kernel has posted
+    void reap() {
+        unsigned head = *cqHead;
+        const unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes[head & cqMask];
+            Batch& batch = batches[cqe.user_data >> 32];
+            const BulkWriteJob& job = batch.jobs[(cqe.user_data & 0xFFFFFFFFu) >> 2];
+            const std::uint64_t op = cqe.user_data & 3;
+            ++batch.completed;
+            if (op == Unlink) {
+                // Nothing there yet is the usual case; the open that follows runs either way
+                if (cqe.res < 0 && cqe.res != -ENOENT) {
+                    fail("Failed to replace " + job.path + ": " + std::strerror(-cqe.res));
+                }
+            } else if (cqe.res < 0) {
+                fail(std::string(op == Open ? "Failed to create " : "Failed to write ") + job.path + ": " +
+                     std::strerror(-cqe.res));
+            } else if (op == Write && static_cast<size_t>(cqe.res) != job.length) {
+                fail("Failed to write " + job.path + ": short write");
+            }
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    bool wait(int index) {
+        Batch& batch = batches[index];
+        if (!batch.submitted) return true;
+        reap();
+        while (batch.completed < batch.expected) {
+            if (enter(ringFd, 0, batch.expected - batch.completed, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+                fail(std::string("io_uring_enter failed: ") + std::strerror(errno));
+                return false;  // The ring is unusable; keep the buffers, the kernel may still read them
+            }
+            reap();
+        }
+        batch.jobs.clear();
+        batch.expected = 0;
+        batch.completed = 0;
+        batch.submitted = false;
+        return true;
+    }
+
+    // Queue the filling batch and switch to the other one once it has drained
+    bool dispatch() {
+        const int index = filling;
+        Batch& batch = batches[index];
+        if (batch.jobs.empty()) return true;
+        if (!wait(1 - index)) return false;
+
+        unsigned tail = *sqTail;
+        const unsigned first = tail;
+        for (size_t i = 0; i < batch.jobs.size(); ++i) {
+            const BulkWriteJob& job = batch.jobs[i];
+            const unsigned slot = static_cast<unsigned>(index * filesPerBatch + i);
+            const std::uint64_t tag = (static_cast<std::uint64_t>(index) << 32) | (i << 2);
+
+            io_uring_sqe* unlink = nextSqe(tail, tag | Unlink);
+            unlink->opcode = IORING_OP_UNLINKAT;
+            unlink->fd = AT_FDCWD;
+            unlink->addr = reinterpret_cast<std::uint64_t>(job.path.c_str());
+            unlink->flags = IOSQE_IO_HARDLINK;  // The open runs whether or not there was a file
+
+            io_uring_sqe* open = nextSqe(tail, tag | Open);
+            open->opcode = IORING_OP_OPENAT;
+            open->fd = AT_FDCWD;
+            open->addr = reinterpret_cast<std::uint64_t>(job.path.c_str());
+            open->len = job.mode;
+            open->open_flags = O_WRONLY | O_CREAT | O_TRUNC;  // O_CLOEXEC is refused for direct slots
+            open->file_index = slot + 1;
+            open->flags = IOSQE_IO_HARDLINK;  // Close runs even when an earlier step fails
+
+            if (job.length > 0) {
+                io_uring_sqe* write = nextSqe(tail, tag | Write);
+                write->opcode = IORING_OP_WRITE;
+                write->fd = static_cast<std::int32_t>(slot);
+                write->addr = reinterpret_cast<std::uint64_t>(job.data);
+                write->len = static_cast<std::uint32_t>(job.length);
+                write->off = 0;
+                write->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+            }
+
+            io_uring_sqe* close = nextSqe(tail, tag | Close);
+            close->opcode = IORING_OP_CLOSE;
+            close->file_index = slot + 1;
+        }
+        __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+        batch.expected = tail - first;
+        batch.submitted = true;
+        for (unsigned submitted = 0; submitted < batch.expected;) {
+            const int rc = enter(ringFd, batch.expected - submitted, 0, 0);
+            if (rc < 0 && errno == EINTR) continue;
+            if (rc <= 0) {
+                fail(std::string("io_uring_enter failed: ") + std::strerror(rc < 0 ? errno : EBUSY));
+                batch.expected = submitted;  // Only what the kernel took will complete
+                break;
+            }
+            submitted += static_cast<unsigned>(rc);
+        }
+        filling = 1 - index;
+        return !failed;
+    }
+
+    bool submit(BulkWriteJob job) override {
+        if (failed) return false;
+        batches[filling].jobs.push_back(std::move(job));
+        return batches[filling].jobs.size() < filesPerBatch || dispatch();
+    }
+
+    bool flush() override {
+        bool ok = dispatch();
+        ok = wait(0) && ok;
+        ok = wait(1) && ok;
+        return ok && !failed;
+    }
+};
+#endif
+
+bool ioUringAvailable() {
+#if defined(__linux__) && defined(PURR_HAVE_IO_URING)
+    static const bool available = []() {
+        BulkFileWriter probe(1, 2, BulkWriteBackend::IoUring);
+        return probe.kind() == BulkWriteBackend::IoUring;
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+BulkFileWriter::BulkFileWriter(size_t threads, size_t queueDepth, BulkWriteBackend requested) {
+    queueDepth = std::max<size_t>(queueDepth, 1);
+#if defined(__linux__) && defined(PURR_HAVE_IO_URING)
+    if (requested == BulkWriteBackend::Auto || requested == BulkWriteBackend::IoUring) {
+        auto ring = std::make_unique<IoUringBackend>();
+        if (ring->setup(queueDepth)) {
+            backend = std::move(ring);
+            return;
+        }
+    }
+#endif
+    if (requested == BulkWriteBackend::Direct) {
+        backend = std::make_unique<DirectBackend>();
+        return;
+    }
+    if (threads == 0) threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 4);
+    backend = std::make_unique<ThreadPoolBackend>(threads, queueDepth);
+}
+
+BulkFileWriter::~BulkFileWriter() = default;
+
+BulkWriteBackend BulkFileWriter::kind() const {
+    return backend->kind();
+}
+
+bool BulkFileWriter::write(const std::string& path, const char* data, size_t length, std::uint32_t mode) {
+    BulkWriteJob job;
+    job.path = path;
+    job.data = data;
+    job.length = length;
+    job.mode = mode;
+    ++statFiles;
+    statBytes += length;
+    return backend->submit(std::move(job));
+}
+
+bool BulkFileWriter::write(const std::string& path, std::vector<char> data, std::uint32_t mode) {
+    BulkWriteJob job;
+    job.path = path;
+    job.owned = std::move(data);
+    job.data = job.owned.data();
+    job.length = job.owned.size();
+    job.mode = mode;
+    ++statFiles;
+    statBytes += job.length;
+    return backend->submit(std::move(job));
+}
+
+bool BulkFileWriter::flush() {
+    return backend->flush();
+}
+
+const std::string& BulkFileWriter::error() const {
+    return backend->error;
+}
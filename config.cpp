@@ -185,6 +185,53 @@ void saveConfig(const std::string& javaPath, const std::string& username, const
     }
 }
 
+DownloadSettings loadDownloadSettings() {
+    DownloadSettings settings;
+
+    ConfigManager config;
+    if (!config.load()) {
+        return settings;
+    }
+
+    settings.artifactStore = config.getValue<bool>("artifact_store", settings.artifactStore);
+    settings.artifactStoreDir = config.getValue<std::string>("artifact_store_dir", settings.artifactStoreDir);
+    settings.streamPackExtract = config.getValue<bool>("stream_pack_extract", settings.streamPackExtract);
+    settings.keepPackArchive = config.getValue<bool>("keep_pack_archive", settings.keepPackArchive);
+    settings.http2 = config.getValue<bool>("http2", settings.http2);
+
+    settings.scheduler.rateLimitBytesPerSecond = config.getValue<std::uint64_t>("download_rate_limit_kb", 0) * 1024;
+    settings.scheduler.maxConcurrent = config.getValue<size_t>("download_max_concurrent", settings.scheduler.maxConcurrent);
+
+    // Per-class caps, keyed by class name ("auth", "manifest", "libraries", "bulk")
+    const json classLimits = config.getValue<json>("download_class_limits", json::object());
+    if (classLimits.is_object()) {
+        for (size_t i = 0; i < TRANSFER_CLASS_COUNT; ++i) {
+            const char* name = transferClassName(static_cast<TransferClass>(i));
+            if (classLimits.contains(name) && classLimits[name].is_number_unsigned()) {
+                settings.scheduler.classLimits[i] = classLimits[name].get<size_t>();
+            }
+        }
+    }
+
+    // Mirror groups, keyed by name: {"origin": "https://...", "urls": ["https://...", ...]}
+    const json mirrors = config.getValue<json>("mirrors", json::object());
+    if (mirrors.is_object()) {
+        for (const auto& [name, group] : mirrors.items()) {
+            if (!group.is_object() || !group.contains("origin") || !group["origin"].is_string()) continue;
+            MirrorGroup mirrorGroup;
+            mirrorGroup.name = name;
+            mirrorGroup.origin = group["origin"].get<std::string>();
+            if (group.contains("urls") && group["urls"].is_array()) {
+                for (const auto& mirror : group["urls"]) {
+                    if (mirror.is_string()) mirrorGroup.mirrors.push_back(mirror.get<std::string>());
+                }
+            }
+            if (!mirrorGroup.mirrors.empty()) settings.mirrors.push_back(std::move(mirrorGroup));
+        }
+    }
+    return settings;
+}
+
 // Utility function to validate RAM values
 bool isValidRamValue(const std::string& ramValue) {
     if (ramValue.empty()) return false;
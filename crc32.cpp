@@ -0,0 +1,275 @@
+#include "include/crc32.h"
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CRC32_X86 1
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define CRC32_ARM 1
+#include <arm_acle.h>
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+#endif
+
+// Kernels are compiled for their instruction set regardless of the global -march, and only
+// ever called after the CPU check
+#if defined(__GNUC__) || defined(__clang__)
+#define PCLMUL_TARGET __attribute__((target("pclmul,sse2")))
+#ifdef __clang__
+#define ARM_CRC_TARGET __attribute__((target("crc")))
+#else
+#define ARM_CRC_TARGET __attribute__((target("+crc")))
+#endif
+#else
+#define PCLMUL_TARGET
+#define ARM_CRC_TARGET
+#endif
+
+namespace {
+
+constexpr std::uint32_t POLYNOMIAL = 0xEDB88320u;  // 0x04C11DB7 bit-reflected
+
+using Crc32Tables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+// tables[k][b]: CRC of byte b followed by k zero bytes
+constexpr Crc32Tables makeTables() {
+    Crc32Tables tables{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ (POLYNOMIAL & (0u - (crc & 1u)));
+        tables[0][i] = crc;
+    }
+    for (size_t k = 1; k < 8; ++k) {
+        for (size_t i = 0; i < 256; ++i) {
+            tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+        }
+    }
+    return tables;
+}
+
+constexpr Crc32Tables TABLES = makeTables();
+
+std::uint32_t loadLE32(const unsigned char* p) {
+    return p[0] | (static_cast<std::uint32_t>(p[1]) << 8) | (static_cast<std::uint32_t>(p[2]) << 16) |
+           (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+std::uint32_t crc32SliceBy8(std::uint32_t crc, const unsigned char* p, size_t length) {
+    crc = ~crc;
+    while (length >= 8) {
+        const std::uint32_t low = loadLE32(p) ^ crc;
+        const std::uint32_t high = loadLE32(p + 4);
+        crc = TABLES[7][low & 0xFF] ^ TABLES[6][(low >> 8) & 0xFF] ^ TABLES[5][(low >> 16) & 0xFF] ^
+              TABLES[4][low >> 24] ^ TABLES[3][high & 0xFF] ^ TABLES[2][(high >> 8) & 0xFF] ^
+              TABLES[1][(high >> 16) & 0xFF] ^ TABLES[0][high >> 24];
+        p += 8;
+        length -= 8;
+    }
+    while (length-- > 0) crc = TABLES[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+#ifdef CRC32_X86
+// Folds 64 bytes per iteration with carry-less multiplies, then Barrett-reduces to 32 bits
+// (Gopal et al., "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ", Intel 2009).
+// length is a multiple of 16 and at least 64; crc is the raw (pre-inverted) register.
+PCLMUL_TARGET std::uint32_t pclmulFold(const unsigned char* p, size_t length, std::uint32_t crc) {
+    alignas(16) static const std::uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+    alignas(16) static const std::uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+    alignas(16) static const std::uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+    alignas(16) static const std::uint64_t poly[] = {0x01db710641, 0x01f7011641};
+
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20));
+    __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+    p += 64;
+    length -= 64;
+
+    // Four independent 128-bit lanes keep the multiplier busy
+    while (length >= 64) {
+        const __m128i x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        const __m128i x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        const __m128i x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        const __m128i x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30)));
+        p += 64;
+        length -= 64;
+    }
+
+    // Fold the four lanes into one
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+    for (const __m128i next : {x2, x3, x4}) {
+        const __m128i x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, next), x5);
+    }
+
+    // Remaining 16-byte blocks
+    while (length >= 16) {
+        const __m128i x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p))), x5);
+        p += 16;
+        length -= 16;
+    }
+
+    // 128 -> 64 bits
+    const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x2b = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2b);
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    x2b = _mm_srli_si128(x1, 4);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x00), x2b);
+
+    // Barrett reduction to 32 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    x2b = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x10);
+    x2b = _mm_clmulepi64_si128(_mm_and_si128(x2b, mask), x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2b);
+    return static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4)));
+}
+
+std::uint32_t crc32Pclmul(std::uint32_t crc, const unsigned char* p, size_t length) {
+    if (length >= 64) {
+        const size_t folded = length & ~static_cast<size_t>(15);
+        crc = ~pclmulFold(p, folded, ~crc);
+        p += folded;
+        length -= folded;
+    }
+    return crc32SliceBy8(crc, p, length);
+}
+
+bool cpuHasPclmul() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    const unsigned ecx = static_cast<unsigned>(info[2]), edx = static_cast<unsigned>(info[3]);
+#else
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+#endif
+    return (ecx & (1u << 1)) && (edx & (1u << 26));  // PCLMULQDQ and SSE2
+}
+#endif // CRC32_X86
+
+#ifdef CRC32_ARM
+ARM_CRC_TARGET std::uint32_t crc32Arm(std::uint32_t crc, const unsigned char* p, size_t length) {
+    crc = ~crc;
+    while (length >= 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p, sizeof(word));  // AArch64 is little-endian here, like the zip format
+        crc = __crc32d(crc, word);
+        p += 8;
+        length -= 8;
+    }
+    while (length-- > 0) crc = __crc32b(crc, *p++);
+    return ~crc;
+}
+
+bool cpuHasArmCrc() {
+#if defined(_WIN32)
+    return IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE) != 0;
+#elif defined(__APPLE__)
+    return true;  // Every Apple AArch64 core has it
+#elif defined(__linux__)
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#elif defined(__ARM_FEATURE_CRC32)
+    return true;
+#else
+    return false;
+#endif
+}
+#endif // CRC32_ARM
+
+using KernelFunction = std::uint32_t (*)(std::uint32_t, const unsigned char*, size_t);
+
+KernelFunction kernelFunction(Crc32Kernel kernel) {
+    if (!crc32KernelSupported(kernel)) return crc32SliceBy8;
+    switch (kernel) {
+#ifdef CRC32_X86
+        case Crc32Kernel::Pclmul: return crc32Pclmul;
+#endif
+#ifdef CRC32_ARM
+        case Crc32Kernel::ArmCrc: return crc32Arm;
+#endif
+        default: return crc32SliceBy8;
+    }
+}
+
+} // namespace
+
+const char* crc32KernelName(Crc32Kernel kernel) {
+    switch (kernel) {
+        case Crc32Kernel::SliceBy8: return "slice-by-8";
+        case Crc32Kernel::Pclmul: return "pclmul";
+        case Crc32Kernel::ArmCrc: return "armv8-crc";
+    }
+    return "unknown";
+}
+
+bool crc32KernelSupported(Crc32Kernel kernel) {
+    switch (kernel) {
+        case Crc32Kernel::SliceBy8:
+            return true;
+        case Crc32Kernel::Pclmul:
+#ifdef CRC32_X86
+        {
+            static const bool supported = cpuHasPclmul();  // cpuid is slow under virtualization
+            return supported;
+        }
+#else
+            return false;
+#endif
+        case Crc32Kernel::ArmCrc:
+#ifdef CRC32_ARM
+        {
+            static const bool supported = cpuHasArmCrc();
+            return supported;
+        }
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+Crc32Kernel crc32ActiveKernel() {
+    static const Crc32Kernel active = [] {
+        if (crc32KernelSupported(Crc32Kernel::Pclmul)) return Crc32Kernel::Pclmul;
+        if (crc32KernelSupported(Crc32Kernel::ArmCrc)) return Crc32Kernel::ArmCrc;
+        return Crc32Kernel::SliceBy8;
+    }();
+    return active;
+}
+
+std::uint32_t crc32Update(std::uint32_t crc, const void* data, size_t length) {
+    static const KernelFunction function = kernelFunction(crc32ActiveKernel());
+    return function(crc, static_cast<const unsigned char*>(data), length);
+}
+
+std::uint32_t crc32Update(Crc32Kernel kernel, std::uint32_t crc, const void* data, size_t length) {
+    return kernelFunction(kernel)(crc, static_cast<const unsigned char*>(data), length);
+}
@@ -1,4 +1,12 @@
 #include "include/download.h"
+#include "include/hash.h"
+#include "include/artifact_store.h"
+#include "include/http_client.h"
+#include "include/file_sink.h"
+#include "include/progress.h"
+#include "include/retry_policy.h"
+#include "include/mirror_registry.h"
+#include "include/http_event_loop.h"
 #include <iostream>
 #include <filesystem>
 #include <curl/curl.h>
@@ -7,392 +15,1296 @@
 #include <chrono>
 #include <thread>
 #include <fstream>
-
+#include <deque>
+#include <iomanip>
+#include <unordered_map>
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <optional>
+#include <functional>
+#include <future>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
 namespace fs = std::filesystem;
 
-// RAII wrapper for CURL handles
-class CurlHandle {
+// Segmented (multi-range) download tuning
+constexpr curl_off_t SEGMENTED_MIN_SIZE = 32LL * 1024 * 1024;
+constexpr std::uint64_t SEGMENT_TARGET_SIZE = 16ULL * 1024 * 1024;
+constexpr std::uint64_t MAX_SEGMENTS = 8;
+
+constexpr size_t BATCH_SINK_BUFFER_SIZE = 256 * 1024;
+
+// RAII wrapper for CURLM multi handles
+class CurlMultiHandle {
 private:
-    CURL* curl;
+    CURLM* multi;
 
 public:
-    CurlHandle() : curl(curl_easy_init()) {}
+    // With multiplex, transfers to the same HTTP/2 host become streams on one connection
+    explicit CurlMultiHandle(bool multiplex = true) : multi(curl_multi_init()) {
+        if (multi) {
+            curl_multi_setopt(multi, CURLMOPT_PIPELINING, multiplex ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+        }
+    }
 
-    ~CurlHandle() {
-        if (curl) {
-            curl_easy_cleanup(curl);
+    ~CurlMultiHandle() {
+        if (multi) {
+            curl_multi_cleanup(multi);
         }
     }
 
-    CURL* get() const { return curl; }
+    CURLM* get() const { return multi; }
 
-    bool isValid() const { return curl != nullptr; }
+    bool isValid() const { return multi != nullptr; }
 
-    CurlHandle(const CurlHandle&) = delete;
-    CurlHandle& operator=(const CurlHandle&) = delete;
+    CurlMultiHandle(const CurlMultiHandle&) = delete;
+    CurlMultiHandle& operator=(const CurlMultiHandle&) = delete;
+};
 
-    CurlHandle(CurlHandle&& other) noexcept : curl(other.curl) {
-        other.curl = nullptr;
+// Hand a curl chunk to the sink; returning short makes curl abort with a write error
+static size_t write_data(const void* ptr, const size_t total_size, FileSink& sink) {
+    const size_t written = sink.write(ptr, total_size);
+    if (written != total_size) {
+        std::cerr << "\nError: Failed to write " << sink.getPath() << std::endl;
     }
+    return written;
+}
 
-    CurlHandle& operator=(CurlHandle&& other) noexcept {
-        if (this != &other) {
-            if (curl) curl_easy_cleanup(curl);
-            curl = other.curl;
-            other.curl = nullptr;
-        }
-        return *this;
+// Decide on another attempt and wait out its backoff; false means give up
+static bool backoffBeforeRetry(RetryState& retry, const AttemptFailure& failure, const std::string& what) {
+    std::chrono::milliseconds delay{0};
+    const RetryDecision decision = retry.next(failure, delay);
+    if (decision != RetryDecision::Retry) {
+        std::cerr << "Giving up on " << what << ": " << retryDecisionText(decision) << std::endl;
+        return false;
     }
-};
-
-// RAII wrapper for FILE handles
-class FileHandle {
-private:
-    FILE* file;
-    std::string filepath;
+    std::cout << "\nRetry attempt " << retry.attempt() << "/" << retry.maxAttempts() << " in "
+             << std::fixed << std::setprecision(1) << (delay.count() / 1000.0) << " s..." << std::endl;
+    std::this_thread::sleep_for(delay);
+    return true;
+}
 
-public:
-    FileHandle(const std::string& path, const char* mode)
-        : file(nullptr), filepath(path) {
-        fopen_s(&file, path.c_str(), mode);
+// Verify file integrity after download
+bool verifyDownloadedFile(const std::string& filepath, curl_off_t expectedSize, bool isStreaming) {
+    if (!fs::exists(filepath)) {
+        std::cerr << "Downloaded file does not exist: " << filepath << std::endl;
+        return false;
     }
 
-    ~FileHandle() {
-        if (file) {
-            fclose(file);
+    try {
+        auto actualSize = fs::file_size(filepath);
+
+        if (actualSize == 0) {
+            std::cerr << "Downloaded file is empty: " << filepath << std::endl;
+            return false;
+        }
+
+        // For streaming downloads, we can't verify exact size, but check if it's reasonable
+        if (isStreaming) {
+            // Minimum size check - modpack should be at least 1MB
+            if (actualSize < 1024 * 1024) {
+                std::cerr << "Downloaded file seems too small: " << actualSize << " bytes" << std::endl;
+                return false;
+            }
+            std::cout << "Downloaded file size: " << (actualSize / (1024.0 * 1024.0)) << " MB" << std::endl;
+        } else {
+            // If we know the expected size, verify it matches
+            if (expectedSize > 0 && actualSize != static_cast<uintmax_t>(expectedSize)) {
+                std::cerr << "Size mismatch: expected " << expectedSize
+                         << " bytes, got " << actualSize << " bytes" << std::endl;
+                return false;
+            }
         }
+
+        return true;
+    } catch (const fs::filesystem_error& e) {
+        std::cerr << "Failed to verify file: " << e.what() << std::endl;
+        return false;
     }
+}
 
-    FILE* get() const { return file; }
+// Size, range support and validators reported by the server
+struct RemoteFileInfo {
+    bool reachable = false;
+    curl_off_t contentLength = 0;
+    bool acceptRanges = false;
+    std::string etag;
+    std::string lastModified;
 
-    bool isValid() const { return file != nullptr; }
+    bool hasValidator() const { return !etag.empty() || !lastModified.empty(); }
+};
 
-    void close() {
-        if (file) {
-            fclose(file);
-            file = nullptr;
-        }
+static std::string headerValue(const std::string& line, size_t colon) {
+    const size_t begin = line.find_first_not_of(" \t", colon + 1);
+    const size_t end = line.find_last_not_of(" \t\r\n");
+    if (begin == std::string::npos || end == std::string::npos || end < begin) return "";
+    return line.substr(begin, end - begin + 1);
+}
+
+static size_t header_callback(const char* buffer, const size_t size, const size_t nitems, void* userdata) {
+    const size_t total = size * nitems;
+    auto* info = static_cast<RemoteFileInfo*>(userdata);
+    const std::string line(buffer, total);
+    std::string lower = line;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    // A redirect restarts header parsing, so only the final response counts
+    if (lower.rfind("http/", 0) == 0) {
+        info->acceptRanges = false;
+        info->etag.clear();
+        info->lastModified.clear();
+    } else if (lower.rfind("accept-ranges:", 0) == 0) {
+        info->acceptRanges = lower.find("bytes") != std::string::npos;
+    } else if (lower.rfind("etag:", 0) == 0) {
+        info->etag = headerValue(line, line.find(':'));
+    } else if (lower.rfind("last-modified:", 0) == 0) {
+        info->lastModified = headerValue(line, line.find(':'));
     }
+    return total;
+}
 
-    const std::string& getPath() const { return filepath; }
+using WriteCallback = size_t (*)(const char*, size_t, size_t, void*);
 
-    FileHandle(const FileHandle&) = delete;
-    FileHandle& operator=(const FileHandle&) = delete;
+// Where the body and headers of a possibly raced transfer go
+struct HedgeTarget {
+    WriteCallback write;
+    void* writeData;
+    RemoteFileInfo* response;           // Receives the headers of the mirror that wins
+    std::function<void(CURL*)> onWin;   // Called with the winning handle before its first body byte
 };
 
-// Progress tracking structure
-struct ProgressData {
-    std::chrono::steady_clock::time_point startTime;
-    std::string filename;
-    bool showProgress;
-    curl_off_t lastDownloaded;
-    std::chrono::steady_clock::time_point lastUpdate;
-
-    ProgressData(const std::string& name, bool show = true)
-        : startTime(std::chrono::steady_clock::now())
-        , filename(name)
-        , showProgress(show)
-        , lastDownloaded(0)
-        , lastUpdate(std::chrono::steady_clock::now()) {}
+struct HedgeRace;
+
+// One mirror's request within a race
+struct HedgeLane {
+    PooledCurlHandle curl;
+    MirrorCandidate candidate;
+    RemoteFileInfo response;
+    HedgeRace* race = nullptr;
+    std::chrono::steady_clock::time_point started;
+    bool running = false;
+    bool recorded = false;  // Outcome already reported to the registry
 };
 
-size_t write_data(const void* ptr, const size_t size, const size_t nmemb, FILE* stream) {
-    if (!stream) {
-        std::cerr << "\nError: File stream is null!" << std::endl;
-        return 0;
+struct HedgeRace {
+    const HedgeTarget* target = nullptr;
+    HedgeLane* winner = nullptr;
+    bool lastResort = false;  // No other mirror left: let an error response through
+};
+
+static void claimLane(HedgeLane& lane) {
+    HedgeRace& race = *lane.race;
+    race.winner = &lane;
+    *race.target->response = lane.response;
+    race.target->onWin(lane.curl.get());
+}
+
+static size_t hedge_write(const char* ptr, const size_t size, const size_t nmemb, void* userdata) {
+    auto* lane = static_cast<HedgeLane*>(userdata);
+    HedgeRace& race = *lane->race;
+    if (!race.winner) {
+        // An error page is not worth winning with while another mirror may still answer properly
+        long responseCode = 0;
+        curl_easy_getinfo(lane->curl.get(), CURLINFO_RESPONSE_CODE, &responseCode);
+        if (responseCode >= 400 && !race.lastResort) return 0;
+        claimLane(*lane);
     }
-    if (!ptr) {
-        std::cerr << "\nError: Data pointer is null!" << std::endl;
-        return 0;
+    if (race.winner != lane) return 0;  // Another mirror answered first
+    return race.target->write(ptr, size, nmemb, race.target->writeData);
+}
+
+static size_t hedge_header(const char* buffer, const size_t size, const size_t nitems, void* userdata) {
+    auto* lane = static_cast<HedgeLane*>(userdata);
+    HedgeRace& race = *lane->race;
+    if (race.winner && race.winner != lane) return 0;
+    header_callback(buffer, size, nitems, &lane->response);
+    if (race.winner == lane) header_callback(buffer, size, nitems, race.target->response);
+    return size * nitems;
+}
+
+static MirrorSample mirrorSample(CURL* curl, CURLcode result) {
+    MirrorSample sample;
+    long responseCode = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+    sample.ok = result == CURLE_OK && responseCode < 400;
+
+    curl_off_t ttfb = 0, total = 0, bytes = 0;
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &ttfb);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &bytes);
+    sample.ttfbMs = static_cast<double>(ttfb) / 1000.0;
+    sample.seconds = static_cast<double>(total) / 1e6;
+    sample.bytes = static_cast<std::uint64_t>(bytes);
+    return sample;
+}
+
+// Run one attempt of a transfer against the ranked mirrors of url. configure sets every option
+// except the URL and the write/header callbacks. Without mirrors this is a plain perform on curl.
+// Otherwise the best mirror is asked first; if it has not answered within its p95 time to first
+// byte the next one is raced against it, and a mirror that fails before anyone won is replaced
+// at once. The first to deliver a body byte (or finish) wins and the rest are dropped, so the
+// target only ever sees one response. Every lane that completes is counted in the client's
+// connection stats. On return curl holds the winning handle and sourceUrl the URL it fetched.
+static CURLcode performHedged(const std::string& url, const std::function<void(CURL*)>& configure,
+                              const HedgeTarget& target, PooledCurlHandle& curl, std::string& sourceUrl) {
+    constexpr auto POLL_INTERVAL = std::chrono::milliseconds(100);
+    MirrorRegistry& registry = MirrorRegistry::getInstance();
+    const std::vector<MirrorCandidate> candidates = registry.candidates(url);
+
+    if (candidates.size() == 1) {
+        configure(curl.get());
+        curl_easy_setopt(curl.get(), CURLOPT_URL, candidates[0].url.c_str());
+        curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, target.write);
+        curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, target.writeData);
+        curl_easy_setopt(curl.get(), CURLOPT_HEADERFUNCTION, header_callback);
+        curl_easy_setopt(curl.get(), CURLOPT_HEADERDATA, target.response);
+        target.onWin(curl.get());
+        sourceUrl = candidates[0].url;
+        const CURLcode result = curl_easy_perform(curl.get());
+        HttpClient::getInstance().recordTransfer(curl.get());
+        registry.record(candidates[0].base, mirrorSample(curl.get(), result));
+        return result;
     }
 
-    const size_t total_size = size * nmemb;
-    const size_t written = fwrite(ptr, 1, total_size, stream);
+    CurlMultiHandle multi;
+    if (!multi.isValid()) return CURLE_FAILED_INIT;
+
+    HedgeRace race;
+    race.target = &target;
+    std::vector<std::unique_ptr<HedgeLane>> lanes;
+    size_t nextCandidate = 0;
+    size_t running = 0;
+    auto hedgeAt = std::chrono::steady_clock::time_point::max();
+
+    auto startLane = [&]() {
+        while (nextCandidate < candidates.size()) {
+            auto lane = std::make_unique<HedgeLane>();
+            lane->candidate = candidates[nextCandidate++];
+            lane->race = &race;
+            // The caller's handle serves the first lane, and stays with the caller until it is running
+            const bool callerHandle = lanes.empty();
+            CURL* handle = callerHandle ? curl.get() : lane->curl.get();
+            if (!handle) continue;
+
+            configure(handle);
+            // Racing lanes set the URL directly so they never queue behind one another
+            curl_easy_setopt(handle, CURLOPT_URL, lane->candidate.url.c_str());
+            curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, hedge_write);
+            curl_easy_setopt(handle, CURLOPT_WRITEDATA, lane.get());
+            curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, hedge_header);
+            curl_easy_setopt(handle, CURLOPT_HEADERDATA, lane.get());
+            curl_easy_setopt(handle, CURLOPT_PRIVATE, lane.get());
+            if (curl_multi_add_handle(multi.get(), handle) != CURLM_OK) continue;
+            if (callerHandle) lane->curl = std::move(curl);
+
+            lane->started = std::chrono::steady_clock::now();
+            lane->running = true;
+            hedgeAt = lane->started + lane->candidate.hedgeAfter;
+            lanes.push_back(std::move(lane));
+            ++running;
+            race.lastResort = running == 1 && nextCandidate == candidates.size();
+            return true;
+        }
+        return false;
+    };
+
+    auto stopLane = [&](HedgeLane& lane) {
+        curl_multi_remove_handle(multi.get(), lane.curl.get());
+        lane.running = false;
+        --running;
+    };
+
+    HedgeLane* finished = nullptr;
+    CURLcode result = CURLE_FAILED_INIT;
+    bool pruned = false;
+    if (!startLane()) return result;
+
+    while (!finished) {
+        int stillRunning = 0;
+        curl_multi_perform(multi.get(), &stillRunning);
+
+        int queued = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi.get(), &queued)) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            HedgeLane* lane = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &lane);
+            if (!lane || !lane->running) continue;
+            stopLane(*lane);
+            HttpClient::getInstance().recordTransfer(lane->curl.get());
+
+            if (race.winner == lane) {
+                finished = lane;
+                result = msg->data.result;
+                break;
+            }
+            if (race.winner) continue;
+
+            // Nobody has won yet: a body-less success (304, empty file) wins outright
+            const MirrorSample sample = mirrorSample(lane->curl.get(), msg->data.result);
+            if (sample.ok || (race.lastResort && msg->data.result == CURLE_OK)) {
+                claimLane(*lane);
+                finished = lane;
+                result = msg->data.result;
+                break;
+            }
 
-    if (written != total_size) {
-        std::cerr << "\nWarning: Write incomplete (expected " << total_size
-                 << " bytes, wrote " << written << " bytes)" << std::endl;
+            // A dead or failing mirror: ask the next one now instead of waiting for the hedge
+            registry.record(lane->candidate.base, sample);
+            lane->recorded = true;
+            if (!startLane() && running == 0) {
+                claimLane(*lane);
+                finished = lane;
+                result = msg->data.result;
+                break;
+            }
+            race.lastResort = running == 1 && nextCandidate == candidates.size();
+        }
+
+        if (race.winner && !pruned) {
+            // Everyone else lost the race; their wait says how slow they were
+            pruned = true;
+            const auto now = std::chrono::steady_clock::now();
+            for (auto& lane : lanes) {
+                if (lane.get() == race.winner || !lane->running) continue;
+                stopLane(*lane);
+                registry.recordSlow(lane->candidate.base,
+                                    std::chrono::duration<double, std::milli>(now - lane->started).count());
+            }
+        }
+        if (finished) break;
+
+        const auto now = std::chrono::steady_clock::now();
+        if (!race.winner && now >= hedgeAt && nextCandidate < candidates.size()) {
+            std::cout << "\nNo response from " << lanes.back()->candidate.base << " yet, also trying "
+                     << candidates[nextCandidate].base << std::endl;
+            startLane();
+        }
+
+        auto wait = POLL_INTERVAL;
+        if (!race.winner && hedgeAt > now) {
+            wait = std::min(wait, std::chrono::duration_cast<std::chrono::milliseconds>(hedgeAt - now) + std::chrono::milliseconds(1));
+        }
+        curl_multi_poll(multi.get(), nullptr, 0, static_cast<int>(wait.count()), nullptr);
     }
 
-    return written;
+    for (auto& lane : lanes) {
+        if (lane->running) stopLane(*lane);
+    }
+    if (!finished->recorded) {
+        registry.record(finished->candidate.base, mirrorSample(finished->curl.get(), result));
+    }
+    sourceUrl = finished->candidate.url;
+    std::swap(curl, finished->curl);
+    return result;
 }
 
-int progress_func(void* ptr, const curl_off_t TotalToDownload, const curl_off_t NowDownloaded,
-                 curl_off_t /*TotalToUpload*/, curl_off_t /*NowUploaded*/) {
-    if (!ptr) return 0;
+// Resume state kept next to a .part file so interrupted downloads survive retries and restarts
+struct PartialDownloadState {
+    std::string url;
+    std::string etag;
+    std::string lastModified;
+    std::uint64_t totalSize = 0;
+    std::uint64_t bytesWritten = 0;             // Contiguous bytes from the start of the file
+    std::vector<std::uint64_t> segmentWritten;  // Per-range progress of a segmented download
+
+    // If-Range needs a strong validator, so weak ETags fall back to Last-Modified
+    std::string ifRangeValidator() const {
+        if (!etag.empty() && etag.rfind("W/", 0) != 0) return etag;
+        return lastModified;
+    }
 
-    auto* progressData = static_cast<ProgressData*>(ptr);
-    if (!progressData->showProgress) return 0;
+    bool matches(const std::string& otherUrl, const RemoteFileInfo& remote) const {
+        if (url != otherUrl || !remote.hasValidator()) return false;
+        return etag == remote.etag && lastModified == remote.lastModified;
+    }
 
-    // Update progress only every 250ms to reduce console spam
-    auto currentTime = std::chrono::steady_clock::now();
-    auto timeSinceLastUpdate = std::chrono::duration_cast<std::chrono::milliseconds>(
-        currentTime - progressData->lastUpdate);
+    bool load(const std::string& path) {
+        try {
+            std::ifstream ifs(path);
+            if (!ifs.is_open()) return false;
+
+            json j;
+            ifs >> j;
+            url = j.value("url", "");
+            etag = j.value("etag", "");
+            lastModified = j.value("last_modified", "");
+            totalSize = j.value("total_size", std::uint64_t{0});
+            bytesWritten = j.value("bytes_written", std::uint64_t{0});
+            segmentWritten = j.value("segments", std::vector<std::uint64_t>{});
+            return !url.empty();
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
 
-    if (timeSinceLastUpdate.count() < 250 && NowDownloaded > 0) {
-        return 0;
+    // Written to a temp file first so a crash never leaves a truncated sidecar
+    bool save(const std::string& path) const {
+        const std::string tempPath = path + ".tmp";
+        try {
+            {
+                std::ofstream ofs(tempPath, std::ios::trunc);
+                if (!ofs.is_open()) return false;
+
+                json j;
+                j["url"] = url;
+                j["etag"] = etag;
+                j["last_modified"] = lastModified;
+                j["total_size"] = totalSize;
+                j["bytes_written"] = bytesWritten;
+                j["segments"] = segmentWritten;
+                ofs << j.dump();
+                if (!ofs) return false;
+            }
+            fs::rename(tempPath, path);
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
     }
+};
 
-    progressData->lastUpdate = currentTime;
+static std::string partPathFor(const std::string& outputPath) { return outputPath + ".part"; }
+static std::string statePathFor(const std::string& outputPath) { return outputPath + ".part.json"; }
 
-    // Check if this is a streaming download (no known total size)
-    bool isStreaming = (TotalToDownload <= 0);
+static void discardPartial(const std::string& outputPath) {
+    std::error_code ec;
+    fs::remove(partPathFor(outputPath), ec);
+    fs::remove(statePathFor(outputPath), ec);
+}
+
+// Move a completed .part into place and drop its sidecar
+static bool commitPartial(const std::string& outputPath) {
+    try {
+        if (fs::exists(outputPath)) fs::remove(outputPath);
+        fs::rename(partPathFor(outputPath), outputPath);
+    } catch (const fs::filesystem_error& e) {
+        std::cerr << "Failed to finalize " << outputPath << ": " << e.what() << std::endl;
+        return false;
+    }
 
-    if (isStreaming) {
-        // Streaming mode - show spinner and downloaded size only
-        const char spinner[] = {'|', '/', '-', '\\'};
-        static int spinnerIndex = 0;
-        spinnerIndex = (spinnerIndex + 1) % 4;
+    std::error_code ec;
+    fs::remove(statePathFor(outputPath), ec);
+    return true;
+}
 
-        std::cout << "\r[" << spinner[spinnerIndex] << "] Downloading";
+// Validators of a previously downloaded file, used for conditional requests
+struct CachedValidators {
+    std::string etag;
+    std::string lastModified;
+    std::uint64_t size = 0;
+    std::string hashAlgorithm;  // "sha1" / "sha256", empty when no digest was computed
+    std::string digest;
+};
 
-        // Calculate download speed
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(currentTime - progressData->startTime);
-        if (elapsed.count() > 0 && NowDownloaded > 0) {
-            double speedKBs = static_cast<double>(NowDownloaded) / elapsed.count() / 1024.0;
+static const char* hashKey(HashAlgorithm algorithm) {
+    return algorithm == HashAlgorithm::SHA256 ? "sha256" : "sha1";
+}
 
-            // Show speed in appropriate units
-            if (speedKBs > 1024.0) {
-                std::cout << " (" << std::fixed << std::setprecision(2) << (speedKBs / 1024.0) << " MB/s)";
-            } else {
-                std::cout << " (" << std::fixed << std::setprecision(1) << speedKBs << " KB/s)";
+// On-disk ETag/Last-Modified store keyed by URL
+class ValidatorCache {
+private:
+    static constexpr const char* CACHE_FILE = "http_cache.json";
+    std::mutex cacheMutex;
+    json entries = json::object();
+    bool loaded = false;
+
+    void ensureLoaded() {
+        if (loaded) return;
+        loaded = true;
+        try {
+            std::ifstream ifs(CACHE_FILE);
+            if (ifs.is_open()) {
+                ifs >> entries;
             }
+        } catch (const json::exception& e) {
+            std::cerr << "Ignoring corrupt HTTP cache: " << e.what() << std::endl;
         }
+        if (!entries.is_object()) entries = json::object();
+    }
 
-        // Show downloaded size
-        double downloadedMB = static_cast<double>(NowDownloaded) / (1024.0 * 1024.0);
-        std::cout << " [" << std::fixed << std::setprecision(1) << downloadedMB << " MB]";
-    } else {
-        // Normal mode with known size - show progress bar
-        constexpr int totaldotz = 40;
-        const double fractiondownloaded = static_cast<double>(NowDownloaded) / static_cast<double>(TotalToDownload);
-        const int dotz = static_cast<int>(fractiondownloaded * totaldotz);
-
-        // Calculate download speed
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(currentTime - progressData->startTime);
+    ValidatorCache() = default;
 
-        std::cout << "\r[";
-        for (int i = 0; i < dotz; ++i) std::cout << "=";
-        for (int i = dotz; i < totaldotz; ++i) std::cout << " ";
+public:
+    static ValidatorCache& getInstance() {
+        static ValidatorCache instance;
+        return instance;
+    }
 
-        std::cout << "] " << static_cast<int>(fractiondownloaded * 100) << "%";
+    bool lookup(const std::string& url, CachedValidators& out) {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        ensureLoaded();
+        if (!entries.contains(url) || !entries[url].is_object()) return false;
+
+        const json& entry = entries[url];
+        out.etag = entry.value("etag", "");
+        out.lastModified = entry.value("last_modified", "");
+        out.size = entry.value("size", std::uint64_t{0});
+        out.hashAlgorithm = entry.value("hash_algorithm", "");
+        out.digest = entry.value("digest", "");
+        return !out.etag.empty() || !out.lastModified.empty();
+    }
 
-        // Show download speed and ETA
-        if (elapsed.count() > 0 && NowDownloaded > 0) {
-            double speedKBs = static_cast<double>(NowDownloaded) / elapsed.count() / 1024.0;
+    void store(const std::string& url, const CachedValidators& validators) {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        ensureLoaded();
+        entries[url] = {
+            {"etag", validators.etag},
+            {"last_modified", validators.lastModified},
+            {"size", validators.size}
+        };
+        if (!validators.digest.empty()) {
+            entries[url]["hash_algorithm"] = validators.hashAlgorithm;
+            entries[url]["digest"] = validators.digest;
+        }
 
-            if (speedKBs > 1024.0) {
-                std::cout << " (" << std::fixed << std::setprecision(2) << (speedKBs / 1024.0) << " MB/s";
-            } else {
-                std::cout << " (" << std::fixed << std::setprecision(1) << speedKBs << " KB/s";
+        const std::string tempPath = std::string(CACHE_FILE) + ".tmp";
+        try {
+            {
+                std::ofstream ofs(tempPath, std::ios::trunc);
+                if (!ofs.is_open()) return;
+                ofs << entries.dump(4);
             }
+            fs::rename(tempPath, CACHE_FILE);
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to save HTTP cache: " << e.what() << std::endl;
+        }
+    }
+};
 
-            // Calculate ETA
-            if (speedKBs > 0 && TotalToDownload > NowDownloaded) {
-                double remainingBytes = TotalToDownload - NowDownloaded;
-                double etaSeconds = remainingBytes / (speedKBs * 1024.0);
-                if (etaSeconds < 3600) {
-                    int minutes = static_cast<int>(etaSeconds / 60);
-                    int seconds = static_cast<int>(etaSeconds) % 60;
-                    std::cout << ", ETA: " << minutes << "m " << seconds << "s";
-                }
-            }
-            std::cout << ")";
+// RAII wrapper for curl_slist header lists
+class CurlHeaderList {
+private:
+    curl_slist* headers = nullptr;
+
+public:
+    CurlHeaderList() = default;
+
+    ~CurlHeaderList() {
+        if (headers) {
+            curl_slist_free_all(headers);
         }
+    }
+
+    void append(const std::string& header) { headers = curl_slist_append(headers, header.c_str()); }
+
+    curl_slist* get() const { return headers; }
+
+    CurlHeaderList(const CurlHeaderList&) = delete;
+    CurlHeaderList& operator=(const CurlHeaderList&) = delete;
+};
+
+// Rate limiting for a transfer that shares a multi handle with others. Sleeping in its write
+// callback would stall every transfer on the multi, so once it is over budget its next chunk
+// is refused with CURL_WRITEFUNC_PAUSE and the multi loop resumes it when the hold expires.
+struct RateHold {
+    std::chrono::steady_clock::time_point resumeAt{};
+    bool paused = false;
+
+    // At the top of the write callback: true if the chunk must be refused
+    bool holding() {
+        if (std::chrono::steady_clock::now() < resumeAt) {
+            paused = true;
+            return true;
+        }
+        return false;
+    }
 
-        // Show downloaded size
-        double downloadedMB = static_cast<double>(NowDownloaded) / (1024.0 * 1024.0);
-        double totalMB = static_cast<double>(TotalToDownload) / (1024.0 * 1024.0);
-        std::cout << " [" << std::fixed << std::setprecision(1) << downloadedMB << "/" << totalMB << " MB]";
+    // After the chunk has been taken
+    void charge(TransferClass transferClass, size_t bytes) {
+        const auto wait = DownloadScheduler::getInstance().charge(transferClass, bytes);
+        if (wait.count() > 0) resumeAt = std::chrono::steady_clock::now() + wait;
     }
 
-    std::cout << "        " << std::flush; // Extra spaces to clear previous text
+    // From the multi loop: unpause once the hold has expired, otherwise pull wakeAt in to it
+    void resumeIfDue(CURL* handle, std::chrono::steady_clock::time_point now,
+                     std::chrono::steady_clock::time_point& wakeAt) {
+        if (!paused) return;
+        if (now < resumeAt) {
+            wakeAt = std::min(wakeAt, resumeAt);
+            return;
+        }
+        paused = false;
+        curl_easy_pause(handle, CURLPAUSE_CONT);
+    }
+};
 
-    progressData->lastDownloaded = NowDownloaded;
-    return 0;
+// How long the multi loop may block in curl_multi_poll before a held transfer is due
+static int pollTimeout(int defaultMs, std::chrono::steady_clock::time_point now,
+                       std::chrono::steady_clock::time_point wakeAt) {
+    if (wakeAt <= now) return 0;
+    const auto untilWake = std::chrono::duration_cast<std::chrono::milliseconds>(wakeAt - now).count() + 1;
+    return static_cast<int>(std::min<long long>(defaultMs, untilWake));
 }
 
-// Verify file integrity after download
-bool verifyDownloadedFile(const std::string& filepath, curl_off_t expectedSize, bool isStreaming) {
-    if (!fs::exists(filepath)) {
-        std::cerr << "Downloaded file does not exist: " << filepath << std::endl;
-        return false;
+// Digest of the contiguous prefix of a segmented download
+struct PrefixHash {
+    StreamingHash* hash = nullptr;
+    std::uint64_t hashedUpTo = 0;
+};
+
+// One byte range of a segmented download
+struct Segment {
+    std::uint64_t start = 0;
+    std::uint64_t end = 0;     // Inclusive
+    std::uint64_t written = 0;
+    RetryState retry{RetryPolicy::download()};
+    bool rangeIgnored = false;
+    TransferClass transferClass = TransferClass::Bulk;
+    TransferProgress* progress = nullptr;  // Shared by all segments of the file
+    PrefixHash* prefixHash = nullptr;      // Likewise
+    RateHold rateHold;
+    PooledCurlHandle curl;
+    std::unique_ptr<FileSink> file;
+
+    std::uint64_t length() const { return end - start + 1; }
+    bool complete() const { return written == length(); }
+};
+
+static size_t write_segment(const char* ptr, const size_t size, const size_t nmemb, void* userdata) {
+    auto* segment = static_cast<Segment*>(userdata);
+
+    // A 200 means the server sent the whole file instead of our range (or the validator changed)
+    long response_code = 0;
+    curl_easy_getinfo(segment->curl.get(), CURLINFO_RESPONSE_CODE, &response_code);
+    if (response_code != 206) {
+        segment->rangeIgnored = true;
+        return 0;
     }
 
-    try {
-        auto actualSize = fs::file_size(filepath);
+    const size_t total = size * nmemb;
+    if (segment->written + total > segment->length()) {
+        std::cerr << "\nError: Server sent more data than the requested range" << std::endl;
+        return 0;
+    }
+    if (segment->rateHold.holding()) return CURL_WRITEFUNC_PAUSE;
 
-        if (actualSize == 0) {
-            std::cerr << "Downloaded file is empty: " << filepath << std::endl;
+    const size_t written = segment->file->write(ptr, total);
+    // Bytes that extend the hashed prefix go straight into the digest
+    if (PrefixHash* prefix = segment->prefixHash; prefix->hash && segment->start + segment->written == prefix->hashedUpTo) {
+        prefix->hash->update(ptr, written);
+        prefix->hashedUpTo += written;
+    }
+    segment->written += written;
+    segment->progress->add(written);
+    segment->rateHold.charge(segment->transferClass, written);
+    return written;
+}
+
+// (Re)start a segment from the first byte it has not written yet
+static bool startSegment(CURLM* multi, Segment& segment, const std::string& url,
+                         const std::string& partPath, const CurlHeaderList& headers) {
+    if (!segment.file) {
+        segment.file = std::make_unique<FileSink>();
+        if (!segment.file->open(partPath, FileSink::Mode::Update)) return false;
+    }
+    if (!segment.file->seek(segment.start + segment.written)) return false;
+
+    segment.curl = PooledCurlHandle();
+    if (!segment.curl.isValid()) return false;
+    segment.rateHold.paused = false;
+
+    const std::string range = std::to_string(segment.start + segment.written) + "-" + std::to_string(segment.end);
+    CURL* curl = segment.curl.get();
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers.get());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_segment);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &segment);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, &segment);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 10L);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 60L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 512L);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "PurrLauncher/2.4.104");
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_BUFFERSIZE, 524288L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+
+    return curl_multi_add_handle(multi, curl) == CURLM_OK;
+}
+
+// Record per-segment progress (and the contiguous prefix for single-stream fallback).
+// Buffers are flushed first so the sidecar never claims bytes that only live in memory.
+static bool checkpointSegments(PartialDownloadState& state, const std::vector<std::unique_ptr<Segment>>& segments,
+                               const std::string& statePath) {
+    for (const auto& segment : segments) {
+        if (segment->file && !segment->file->flush()) {
+            std::cerr << "\nFailed to write " << segment->file->getPath() << std::endl;
             return false;
         }
+    }
 
-        // For streaming downloads, we can't verify exact size, but check if it's reasonable
-        if (isStreaming) {
-            // Minimum size check - modpack should be at least 1MB
-            if (actualSize < 1024 * 1024) {
-                std::cerr << "Downloaded file seems too small: " << actualSize << " bytes" << std::endl;
-                return false;
+    state.segmentWritten.clear();
+    state.bytesWritten = 0;
+    bool contiguous = true;
+    for (const auto& segment : segments) {
+        state.segmentWritten.push_back(segment->written);
+        if (contiguous) {
+            state.bytesWritten += segment->written;
+            contiguous = segment->complete();
+        }
+    }
+    state.save(statePath);
+    return true;
+}
+
+// Fetch a file as concurrent byte ranges written into a preallocated .part file.
+// Failed segments are retried from their last written byte; progress is checkpointed
+// to the sidecar so a restart resumes every range where it stopped.
+// The hash is fed from the segment writing at the end of the hashed prefix. Bytes that landed
+// ahead of it (the rest of the next segment, or a resumed prefix) are read back at checkpoints,
+// once the prefix reaches them, while they are still in the page cache.
+// On success the complete .part is left for the caller to verify and commit.
+static bool downloadSegmented(const std::string& url, const std::string& sourceUrl, const std::string& outputPath,
+                              const RemoteFileInfo& remote, StreamingHash* hash, TransferClass transferClass) {
+    constexpr int POLL_TIMEOUT_MS = 250;
+    constexpr auto CHECKPOINT_INTERVAL = std::chrono::seconds(1);
+
+    const std::uint64_t totalSize = static_cast<std::uint64_t>(remote.contentLength);
+    const int segmentCount = static_cast<int>(std::clamp<std::uint64_t>(
+        totalSize / SEGMENT_TARGET_SIZE, 2, MAX_SEGMENTS));
+    const std::string partPath = partPathFor(outputPath);
+    const std::string statePath = statePathFor(outputPath);
+
+    // Reuse an earlier partial only if the server copy is byte-for-byte the same file
+    PartialDownloadState state;
+    bool resuming = state.load(statePath) && state.matches(url, remote) && state.totalSize == totalSize;
+    try {
+        resuming = resuming && fs::exists(partPath);
+        if (resuming && state.segmentWritten.size() != static_cast<size_t>(segmentCount)) {
+            // Left by a single-stream attempt: only its contiguous prefix is known good
+            state.bytesWritten = std::min<std::uint64_t>(state.bytesWritten, fs::file_size(partPath));
+            state.segmentWritten.clear();
+            resuming = state.bytesWritten > 0;
+        }
+        if (resuming && fs::file_size(partPath) != totalSize) {
+            fs::resize_file(partPath, totalSize);
+        }
+        if (!resuming) {
+            discardPartial(outputPath);
+            state = PartialDownloadState{url, remote.etag, remote.lastModified, totalSize, 0, {}};
+            // Reserve real blocks first: extending alone leaves a sparse file that fragments as ranges land
+            {
+                FileSink create;
+                if (!create.open(partPath, FileSink::Mode::Truncate)) return false;
+                create.preallocate(totalSize);
             }
-            std::cout << "Downloaded file size: " << (actualSize / (1024.0 * 1024.0)) << " MB" << std::endl;
-        } else {
-            // If we know the expected size, verify it matches
-            if (expectedSize > 0 && actualSize != static_cast<uintmax_t>(expectedSize)) {
-                std::cerr << "Size mismatch: expected " << expectedSize
-                         << " bytes, got " << actualSize << " bytes" << std::endl;
+            fs::resize_file(partPath, totalSize);
+        }
+    } catch (const fs::filesystem_error& e) {
+        std::cerr << "Failed to preallocate " << partPath << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    CurlHeaderList headers;
+    if (const std::string validator = state.ifRangeValidator(); !validator.empty()) {
+        headers.append("If-Range: " + validator);
+    }
+
+    // Ranges exist to spread one file over several connections; multiplexing them onto a
+    // single HTTP/2 connection would undo that
+    CurlMultiHandle multi(false);
+    if (!multi.isValid()) return false;
+
+    PrefixHash prefixHash{hash, 0};
+    if (hash) hash->reset();
+
+    TransferProgress progress = ProgressTracker::getInstance().begin(fs::path(outputPath).filename().string());
+    std::vector<std::unique_ptr<Segment>> segments;
+    size_t remaining = 0;
+    const std::uint64_t segmentSize = totalSize / segmentCount;
+    for (int i = 0; i < segmentCount; ++i) {
+        auto segment = std::make_unique<Segment>();
+        segment->transferClass = transferClass;
+        segment->progress = &progress;
+        segment->prefixHash = &prefixHash;
+        segment->start = segmentSize * i;
+        segment->end = (i == segmentCount - 1) ? totalSize - 1 : segment->start + segmentSize - 1;
+        if (resuming && !state.segmentWritten.empty()) {
+            segment->written = std::min(state.segmentWritten[i], segment->length());
+        } else if (resuming && state.bytesWritten > segment->start) {
+            segment->written = std::min(state.bytesWritten - segment->start, segment->length());
+        }
+
+        if (!segment->complete()) {
+            if (!startSegment(multi.get(), *segment, sourceUrl, partPath, headers)) {
+                std::cerr << "Failed to start download segment " << (i + 1) << std::endl;
+                for (auto& started : segments) curl_multi_remove_handle(multi.get(), started->curl.get());
                 return false;
             }
+            ++remaining;
         }
+        segments.push_back(std::move(segment));
+    }
 
+    if (resuming) {
+        std::cout << "Resuming segmented download (" << std::fixed << std::setprecision(1)
+                 << (state.bytesWritten / (1024.0 * 1024.0)) << " MB already contiguous)" << std::endl;
+    }
+    std::cout << "Downloading in " << segmentCount << " parallel segments" << std::endl;
+
+    std::uint64_t alreadyWritten = 0;
+    for (const auto& segment : segments) alreadyWritten += segment->written;
+    progress.setExpected(totalSize - alreadyWritten);
+
+    std::vector<std::pair<Segment*, std::chrono::steady_clock::time_point>> retryQueue;
+    auto lastCheckpoint = std::chrono::steady_clock::now();
+    bool failed = false;
+    bool validatorChanged = false;
+
+    // Catch the hashed prefix up with the contiguous prefix of the last checkpoint
+    auto hashContiguous = [&]() {
+        if (!hash || state.bytesWritten <= prefixHash.hashedUpTo) return true;
+        if (!hashFileRange(*hash, partPath, prefixHash.hashedUpTo, state.bytesWritten - prefixHash.hashedUpTo)) {
+            std::cerr << "\nFailed to read back " << partPath << " for hashing" << std::endl;
+            return false;
+        }
+        prefixHash.hashedUpTo = state.bytesWritten;
         return true;
-    } catch (const fs::filesystem_error& e) {
-        std::cerr << "Failed to verify file: " << e.what() << std::endl;
+    };
+
+    while (remaining > 0 && !failed) {
+        int running = 0;
+        curl_multi_perform(multi.get(), &running);
+
+        int queued = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi.get(), &queued)) {
+            if (msg->msg != CURLMSG_DONE) continue;
+
+            Segment* segment = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &segment);
+            const AttemptFailure failure = AttemptFailure::fromTransfer(msg->easy_handle, msg->data.result);
+            curl_multi_remove_handle(multi.get(), msg->easy_handle);
+            HttpClient::getInstance().recordTransfer(msg->easy_handle);
+            segment->rateHold.paused = false;
+
+            if (msg->data.result == CURLE_OK && segment->complete()) {
+                --remaining;
+                continue;
+            }
+
+            if (segment->rangeIgnored) {
+                std::cerr << "\nServer ignored the range request or the file changed" << std::endl;
+                validatorChanged = true;
+                failed = true;
+                break;
+            }
+
+            std::cerr << "\nSegment " << segment->start << "-" << segment->end << " failed (attempt "
+                     << segment->retry.attempt() << "/" << segment->retry.maxAttempts() << "): "
+                     << curl_easy_strerror(msg->data.result) << std::endl;
+            std::chrono::milliseconds delay{0};
+            if (const RetryDecision decision = segment->retry.next(failure, delay); decision != RetryDecision::Retry) {
+                std::cerr << "Giving up on the segment: " << retryDecisionText(decision) << std::endl;
+                failed = true;
+                break;
+            }
+            retryQueue.emplace_back(segment, std::chrono::steady_clock::now() + delay);
+        }
+
+        // Restart failed ranges once their delay has passed
+        const auto now = std::chrono::steady_clock::now();
+        for (auto it = retryQueue.begin(); it != retryQueue.end() && !failed;) {
+            if (it->second > now) {
+                ++it;
+                continue;
+            }
+            if (!startSegment(multi.get(), *it->first, sourceUrl, partPath, headers)) {
+                failed = true;
+                break;
+            }
+            it = retryQueue.erase(it);
+        }
+
+        if (now - lastCheckpoint >= CHECKPOINT_INTERVAL) {
+            failed = !checkpointSegments(state, segments, statePath) || !hashContiguous() || failed;
+            lastCheckpoint = now;
+        }
+
+        if (remaining > 0 && !failed) {
+            const auto polled = std::chrono::steady_clock::now();
+            auto wakeAt = std::chrono::steady_clock::time_point::max();
+            for (auto& segment : segments) {
+                segment->rateHold.resumeIfDue(segment->curl.get(), polled, wakeAt);
+            }
+            curl_multi_poll(multi.get(), nullptr, 0, pollTimeout(POLL_TIMEOUT_MS, polled, wakeAt), nullptr);
+        }
+    }
+
+    for (auto& segment : segments) {
+        curl_multi_remove_handle(multi.get(), segment->curl.get());
+    }
+    failed = !checkpointSegments(state, segments, statePath) || failed;
+    if (!failed && !validatorChanged) {
+        failed = !hashContiguous();
+    }
+    for (auto& segment : segments) {
+        if (segment->file && !segment->file->close()) failed = true;
+    }
+    progress.finish();
+
+    if (validatorChanged) {
+        discardPartial(outputPath);
         return false;
     }
+    if (failed) {
+        return false; // Keep the .part and sidecar for the next attempt
+    }
+    if (!verifyDownloadedFile(partPath, static_cast<curl_off_t>(totalSize), false)) {
+        discardPartial(outputPath);
+        return false;
+    }
+    // Segments closed with a plain flush; one sync here covers them all before the rename
+    if (!syncFile(partPath)) {
+        std::cerr << "Failed to sync " << partPath << " to disk" << std::endl;
+        return false;
+    }
+    return true;
 }
 
-// Main download function with retry logic
-bool downloadFile(const std::string& url, const std::string& outputPath) {
-    constexpr int MAX_RETRIES = 3;
-    constexpr int RETRY_DELAY_SECONDS = 2;
+// Write target for single-stream downloads into a .part file
+struct PartWriter {
+    FileSink* file = nullptr;
+    CURL* curl = nullptr;
+    PartialDownloadState* state = nullptr;
+    const RemoteFileInfo* response = nullptr;
+    StreamingHash* hash = nullptr;  // Optional; already holds the resumed prefix
+    TransferProgress* progress = nullptr;
+    TransferClass transferClass = TransferClass::Bulk;
+    std::string statePath;
+    std::uint64_t resumeFrom = 0;
+    std::uint64_t written = 0;
+    std::uint64_t lastCheckpoint = 0;
+    bool started = false;
+    bool allowSegmented = false;    // Hand large ranged files over to downloadSegmented
+    bool switchToSegmented = false;
+};
+
+static size_t write_part(const char* ptr, const size_t size, const size_t nmemb, void* userdata) {
+    constexpr std::uint64_t CHECKPOINT_BYTES = 4ULL * 1024 * 1024;
+    auto* writer = static_cast<PartWriter*>(userdata);
+
+    if (!writer->started) {
+        writer->started = true;
+
+        // A resumed request answered with 200 means If-Range failed: the file changed upstream
+        long response_code = 0;
+        curl_easy_getinfo(writer->curl, CURLINFO_RESPONSE_CODE, &response_code);
+        if (writer->resumeFrom > 0 && response_code == 200) {
+            std::cout << "\nRemote file changed since the partial download; restarting from zero" << std::endl;
+            if (!writer->file->reset()) return 0;
+            writer->resumeFrom = 0;
+            if (writer->hash) writer->hash->reset();
+        }
 
+        curl_off_t contentLength = 0;
+        curl_easy_getinfo(writer->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength);
+        writer->state->totalSize = contentLength > 0 ? static_cast<std::uint64_t>(contentLength) + writer->resumeFrom : 0;
+        writer->progress->setExpected(contentLength > 0 ? static_cast<std::uint64_t>(contentLength) : 0);
+        writer->state->etag = writer->response->etag;
+        writer->state->lastModified = writer->response->lastModified;
+
+        if (writer->state->totalSize > 0) {
+            std::cout << "Expected file size: " << std::fixed << std::setprecision(2)
+                     << (writer->state->totalSize / (1024.0 * 1024.0)) << " MB" << std::endl;
+        } else {
+            std::cout << "Streaming download (size unknown)" << std::endl;
+        }
+
+        // The first response doubles as the probe: large files on servers that honor
+        // ranges are handed to the segmented path, keeping what is already on disk
+        if (writer->allowSegmented && writer->response->acceptRanges && writer->response->hasValidator() &&
+            writer->state->totalSize >= static_cast<std::uint64_t>(SEGMENTED_MIN_SIZE)) {
+            writer->switchToSegmented = true;
+            if (!writer->file->flush()) return 0;
+            writer->state->bytesWritten = writer->resumeFrom;
+            writer->state->save(writer->statePath);
+            return 0;
+        }
+
+        // Best effort; lets the filesystem lay the file out in one piece
+        if (writer->state->totalSize > 0) {
+            writer->file->preallocate(writer->state->totalSize);
+        }
+    }
+
+    const size_t written = write_data(ptr, size * nmemb, *writer->file);
+    if (writer->hash) writer->hash->update(ptr, written);
+    writer->progress->add(written);
+    DownloadScheduler::getInstance().throttle(writer->transferClass, written);
+    writer->written += written;
+    writer->state->bytesWritten = writer->resumeFrom + writer->written;
+
+    // Periodically persist progress so a crash or restart can pick up from here
+    if (writer->written - writer->lastCheckpoint >= CHECKPOINT_BYTES && !writer->state->ifRangeValidator().empty()) {
+        if (!writer->file->flush()) return 0;
+        writer->state->save(writer->statePath);
+        writer->lastCheckpoint = writer->written;
+    }
+    return written;
+}
+
+// Main download function with retry logic.
+// Data goes to <output>.part with a JSON sidecar holding the validators and byte count,
+// so retries and later launches resume with If-Range instead of starting over.
+// When conditional, cached validators are sent and a 304 leaves outputPath untouched.
+// With an algorithm set, the body is hashed as it is written and checked against expectedHash
+// before the .part is moved into place.
+static FetchStatus fetchFile(const std::string& url, const std::string& outputPath, bool conditional,
+                             std::optional<HashAlgorithm> algorithm, const std::string& expectedHash,
+                             std::string& digest, TransferClass transferClass) {
     // Create parent directories if they don't exist
     if (const auto parent = fs::path(outputPath).parent_path(); !parent.empty()) {
         try {
             fs::create_directories(parent);
         } catch (const fs::filesystem_error& e) {
             std::cerr << "Failed to create directories: " << e.what() << std::endl;
-            return false;
+            return FetchStatus::Failed;
         }
     }
 
     // Extract filename for progress display
     std::string filename = fs::path(outputPath).filename().string();
+    const std::string partPath = partPathFor(outputPath);
+    const std::string statePath = statePathFor(outputPath);
+
+    // Validators of the copy already on disk, if it is still intact
+    CachedValidators cached;
+    bool haveCached = false;
+    if (conditional && ValidatorCache::getInstance().lookup(url, cached)) {
+        std::error_code ec;
+        haveCached = fs::exists(outputPath, ec) && (cached.size == 0 || fs::file_size(outputPath, ec) == cached.size);
+
+        // A local copy known to have the wrong content must not be revalidated
+        if (haveCached && algorithm && !expectedHash.empty() && cached.hashAlgorithm == hashKey(*algorithm) &&
+            !digestEquals(cached.digest, expectedHash)) {
+            haveCached = false;
+        }
+    }
 
-    for (int attempt = 1; attempt <= MAX_RETRIES; ++attempt) {
-        if (attempt > 1) {
-            std::cout << "\nRetry attempt " << attempt << "/" << MAX_RETRIES << "..." << std::endl;
-            std::this_thread::sleep_for(std::chrono::seconds(RETRY_DELAY_SECONDS));
+    auto rememberValidators = [&](const PartialDownloadState& state) {
+        if (state.etag.empty() && state.lastModified.empty()) return;
+        std::error_code ec;
+        const auto size = fs::file_size(outputPath, ec);
+        ValidatorCache::getInstance().store(url, {state.etag, state.lastModified, ec ? 0 : size,
+                                                  algorithm && !digest.empty() ? hashKey(*algorithm) : "", digest});
+    };
+
+    // Check the streamed digest, then move the .part into place
+    auto finishDownload = [&](StreamingHash* hash, const PartialDownloadState& state) {
+        digest = hash ? hash->finish() : "";
+        if (hash && !expectedHash.empty() && !digestEquals(digest, expectedHash)) {
+            std::cerr << hashAlgorithmName(*algorithm) << " mismatch for " << filename << ": expected "
+                     << expectedHash << ", got " << digest << std::endl;
+            discardPartial(outputPath);
+            digest.clear();
+            return false;
         }
+        if (!commitPartial(outputPath)) return false;
+        rememberValidators(state);
+        if (hash) ArtifactStore::getInstance().add(*algorithm, digest, outputPath);
+        return true;
+    };
+
+    // Known content may already be in the shared store from another instance
+    if (algorithm && !expectedHash.empty() && ArtifactStore::getInstance().install(*algorithm, expectedHash, outputPath)) {
+        discardPartial(outputPath);
+        digest = expectedHash;
+        std::transform(digest.begin(), digest.end(), digest.begin(), [](unsigned char c) { return std::tolower(c); });
+        std::cout << "Installed from artifact store: " << filename << std::endl;
+        return FetchStatus::Downloaded;
+    }
 
-        // Remove partial file from previous failed attempt
-        if (attempt > 1 && fs::exists(outputPath)) {
-            try {
-                fs::remove(outputPath);
-                std::cout << "Removed incomplete file from previous attempt" << std::endl;
-            } catch (const fs::filesystem_error& e) {
-                std::cerr << "Warning: Failed to remove incomplete file: " << e.what() << std::endl;
+    bool segmentedTried = false;
+
+    // Held across retries and the segmented handover so a download counts once against its class cap
+    TransferSlot slot = DownloadScheduler::getInstance().acquire(transferClass);
+
+    RetryState retry(RetryPolicy::download());
+    std::optional<AttemptFailure> failure;  // Why the last attempt failed; empty when the next one starts at once
+    while (true) {
+        if (failure) {
+            if (!backoffBeforeRetry(retry, *failure, filename)) return FetchStatus::Failed;
+            failure.reset();
+        }
+
+        // Resume from an earlier partial only when it has a validator to guard the range
+        std::optional<StreamingHash> hasher;
+        if (algorithm) hasher.emplace(*algorithm);
+        StreamingHash* hash = hasher ? &*hasher : nullptr;
+
+        // An interrupted segmented download resumes its ranges directly; the single-stream
+        // path below would truncate the .part to its contiguous prefix and lose later segments
+        if (PartialDownloadState saved; !segmentedTried && saved.load(statePath) && saved.url == url &&
+                                        !saved.segmentWritten.empty() && saved.totalSize > 0 && fs::exists(partPath)) {
+            segmentedTried = true;
+            RemoteFileInfo remote;
+            remote.reachable = true;
+            remote.contentLength = static_cast<curl_off_t>(saved.totalSize);
+            remote.acceptRanges = true;
+            remote.etag = saved.etag;
+            remote.lastModified = saved.lastModified;
+            const std::string sourceUrl = MirrorRegistry::getInstance().candidates(url).front().url;
+            if (downloadSegmented(url, sourceUrl, outputPath, remote, hash, transferClass)) {
+                if (finishDownload(hash, saved)) {
+                    std::cout << "✓ Download completed successfully: " << filename << std::endl;
+                    return FetchStatus::Downloaded;
+                }
+                failure = AttemptFailure::local();
+                continue;
             }
+            std::cout << "Segmented download failed, falling back to a single stream..." << std::endl;
+            if (hash) hash->reset();
         }
 
-        CurlHandle curl;
+        PartialDownloadState state;
+        std::uint64_t resumeFrom = 0;
+        try {
+            if (state.load(statePath) && state.url == url && !state.ifRangeValidator().empty() &&
+                fs::exists(partPath)) {
+                resumeFrom = std::min<std::uint64_t>(fs::file_size(partPath), state.bytesWritten);
+            }
+            if (resumeFrom > 0) {
+                fs::resize_file(partPath, resumeFrom); // Drop anything written after the last checkpoint
+            }
+            if (resumeFrom > 0 && hash && !hashFileRange(*hash, partPath, 0, resumeFrom)) {
+                hash->reset();
+                resumeFrom = 0; // Unreadable prefix: cheaper to start over than to trust it
+            }
+            if (resumeFrom == 0) {
+                discardPartial(outputPath);
+                state = PartialDownloadState{};
+                state.url = url;
+            }
+        } catch (const fs::filesystem_error& e) {
+            std::cerr << "Warning: Failed to inspect partial download: " << e.what() << std::endl;
+            discardPartial(outputPath);
+            resumeFrom = 0;
+            if (hash) hash->reset();
+            state = PartialDownloadState{};
+            state.url = url;
+        }
+
+        PooledCurlHandle curl;
         if (!curl.isValid()) {
             std::cerr << "Failed to initialize CURL" << std::endl;
-            if (attempt == MAX_RETRIES) return false;
+            failure = AttemptFailure::local();
             continue;
         }
 
-        FileHandle file(outputPath, "wb");
-        if (!file.isValid()) {
-            std::cerr << "Failed to open file for writing: " << outputPath << std::endl;
-            if (attempt == MAX_RETRIES) return false;
+        FileSink file;
+        if (!file.open(partPath, resumeFrom > 0 ? FileSink::Mode::Append : FileSink::Mode::Truncate)) {
+            std::cerr << "Failed to open file for writing: " << partPath << std::endl;
+            failure = AttemptFailure::local();
             continue;
         }
 
-        ProgressData progressData(filename);
+        TransferProgress progress = ProgressTracker::getInstance().begin(filename);
+        RemoteFileInfo response;
+        PartWriter writer;
+        writer.file = &file;
+        writer.progress = &progress;
+        writer.state = &state;
+        writer.response = &response;
+        writer.hash = hash;
+        writer.transferClass = transferClass;
+        writer.statePath = statePath;
+        writer.resumeFrom = resumeFrom;
+        writer.allowSegmented = !segmentedTried;
+
+        // Resume an interrupted download; If-Range makes the server send the whole file if it changed.
+        // CURLOPT_RANGE rather than RESUME_FROM so a 200 reply reaches write_part instead of failing.
+        CurlHeaderList headers;
+        const std::string resumeRange = std::to_string(resumeFrom) + "-";
+        if (resumeFrom > 0) {
+            headers.append("If-Range: " + state.ifRangeValidator());
+            std::cout << "Resuming download from " << (resumeFrom / (1024.0 * 1024.0)) << " MB..." << std::endl;
+        }
+
+        // Ask the server to skip the body when our copy is current (no HEAD round trip needed)
+        if (haveCached && resumeFrom == 0) {
+            if (!cached.etag.empty()) headers.append("If-None-Match: " + cached.etag);
+            if (!cached.lastModified.empty()) headers.append("If-Modified-Since: " + cached.lastModified);
+        }
 
-        // Configure CURL options
-        curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, write_data);
-        curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, file.get());
-        curl_easy_setopt(curl.get(), CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl.get(), CURLOPT_MAXREDIRS, 10L);
-        curl_easy_setopt(curl.get(), CURLOPT_NOPROGRESS, 0L);
-        curl_easy_setopt(curl.get(), CURLOPT_XFERINFOFUNCTION, progress_func);
-        curl_easy_setopt(curl.get(), CURLOPT_XFERINFODATA, &progressData);
-        curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, write_data);
-        curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, file.get());
-        curl_easy_setopt(curl.get(), CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl.get(), CURLOPT_MAXREDIRS, 10L);
-        curl_easy_setopt(curl.get(), CURLOPT_NOPROGRESS, 0L);
-        curl_easy_setopt(curl.get(), CURLOPT_XFERINFOFUNCTION, progress_func);
-        curl_easy_setopt(curl.get(), CURLOPT_XFERINFODATA, &progressData);
+        // Configure CURL options (applied to every mirror raced for this attempt)
+        auto configure = [&](CURL* handle) {
+            curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+            curl_easy_setopt(handle, CURLOPT_MAXREDIRS, 10L);
 
-        // Timeouts - adjusted for streaming downloads
-        curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, 30L);
-        curl_easy_setopt(curl.get(), CURLOPT_LOW_SPEED_TIME, 120L);  // Allow 120s of slow speed for streaming
-        curl_easy_setopt(curl.get(), CURLOPT_LOW_SPEED_LIMIT, 512L); // 512 bytes/s minimum (very low for streaming)
+            // Timeouts - adjusted for streaming downloads
+            curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, 30L);
+            curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, 120L);  // Allow 120s of slow speed for streaming
+            curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, 512L); // 512 bytes/s minimum (very low for streaming)
 
-        // Enable compression
-        curl_easy_setopt(curl.get(), CURLOPT_ACCEPT_ENCODING, "");
+            // No Accept-Encoding: byte offsets must refer to the stored file for resume to work
 
-        // Set user agent
-        curl_easy_setopt(curl.get(), CURLOPT_USERAGENT, "PurrLauncher/2.4.104");
+            // Set user agent
+            curl_easy_setopt(handle, CURLOPT_USERAGENT, "PurrLauncher/2.4.104");
 
-        // Performance optimizations
-        curl_easy_setopt(curl.get(), CURLOPT_TCP_KEEPALIVE, 1L);
-        curl_easy_setopt(curl.get(), CURLOPT_TCP_NODELAY, 1L); // Disable Nagle's algorithm for streaming
-        curl_easy_setopt(curl.get(), CURLOPT_BUFFERSIZE, 524288L); // 512KB buffer for large files
+            // Performance optimizations
+            curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+            curl_easy_setopt(handle, CURLOPT_TCP_NODELAY, 1L); // Disable Nagle's algorithm for streaming
+            curl_easy_setopt(handle, CURLOPT_BUFFERSIZE, 524288L); // 512KB buffer for large files
 
-        // SSL options
-        curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYPEER, 1L);
-        curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYHOST, 2L);
+            // SSL options
+            curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 1L);
+            curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 2L);
 
-        // Support for chunked transfer encoding (streaming)
-        curl_easy_setopt(curl.get(), CURLOPT_HTTP_TRANSFER_DECODING, 1L);
-        curl_easy_setopt(curl.get(), CURLOPT_HTTP_CONTENT_DECODING, 1L);
+            // Support for chunked transfer encoding (streaming)
+            curl_easy_setopt(handle, CURLOPT_HTTP_TRANSFER_DECODING, 1L);
 
-        // Enable resume support for interrupted downloads (not for first attempt)
-        if (attempt > 1 && fs::exists(outputPath)) {
-            try {
-                auto fileSize = fs::file_size(outputPath);
-                // Only resume if we have a significant partial download
-                if (fileSize > 1024 * 1024) { // At least 1MB
-                    curl_easy_setopt(curl.get(), CURLOPT_RESUME_FROM_LARGE, static_cast<curl_off_t>(fileSize));
-                    std::cout << "Resuming download from " << (fileSize / (1024.0 * 1024.0)) << " MB..." << std::endl;
-                }
-            } catch (...) {
-                // Ignore resume errors
-            }
-        }
+            if (resumeFrom > 0) curl_easy_setopt(handle, CURLOPT_RANGE, resumeRange.c_str());
+            if (headers.get()) curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers.get());
+        };
 
         std::cout << "Downloading: " << filename << std::endl;
 
-        // Try to get file size with HEAD request (optional, don't fail if it doesn't work)
-        if (attempt == 1) {
-            CurlHandle headCurl;
-            if (headCurl.isValid()) {
-                curl_easy_setopt(headCurl.get(), CURLOPT_URL, url.c_str());
-                curl_easy_setopt(headCurl.get(), CURLOPT_NOBODY, 1L);
-                curl_easy_setopt(headCurl.get(), CURLOPT_FOLLOWLOCATION, 1L);
-                curl_easy_setopt(headCurl.get(), CURLOPT_USERAGENT, "PurrLauncher/2.4.104");
-                curl_easy_setopt(headCurl.get(), CURLOPT_CONNECTTIMEOUT, 10L);
-                curl_easy_setopt(headCurl.get(), CURLOPT_TIMEOUT, 15L);
-
-                CURLcode head_res = curl_easy_perform(headCurl.get());
-
-                if (head_res == CURLE_OK) {
-                    curl_off_t content_length = 0;
-                    curl_easy_getinfo(headCurl.get(), CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &content_length);
-                    if (content_length > 0) {
-                        std::cout << "Expected file size: " << std::fixed << std::setprecision(2)
-                                 << (content_length / (1024.0 * 1024.0)) << " MB" << std::endl;
-                    } else {
-                        std::cout << "Streaming download (size unknown)" << std::endl;
-                    }
+        std::string sourceUrl;
+        CURLcode res = performHedged(url, configure, {write_part, &writer, &response, [&](CURL* handle) { writer.curl = handle; }},
+                                     curl, sourceUrl);
+
+        progress.finish();
+        if (sourceUrl != url) {
+            std::cout << "Fetched from mirror: " << sourceUrl << std::endl;
+        }
+
+        if (writer.switchToSegmented) {
+            file.close();
+            segmentedTried = true;
+
+            RemoteFileInfo remote = response;
+            remote.contentLength = static_cast<curl_off_t>(state.totalSize);
+            if (downloadSegmented(url, sourceUrl, outputPath, remote, hash, transferClass)) {
+                if (finishDownload(hash, state)) {
+                    std::cout << "✓ Download completed successfully: " << filename << std::endl;
+                    return FetchStatus::Downloaded;
                 }
+                failure = AttemptFailure::local();
+                continue;
             }
+            // The handover was not a failed attempt of its own: the single stream starts at once
+            std::cout << "Segmented download failed, falling back to a single stream..." << std::endl;
+            continue;
         }
 
-        CURLcode res = curl_easy_perform(curl.get());
-
-        // CRITICAL: Close and flush file BEFORE any verification
-        file.close();
+        // A finished body is synced before it can be renamed into place; anything else
+        // only needs to reach the OS so the checkpointed prefix is there on resume
+        const bool closed = file.close(res == CURLE_OK ? SyncPolicy::Fsync : SyncPolicy::Flush);
 
-        // Give filesystem time to sync (especially on Windows)
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (!closed) {
+            std::cerr << "Failed to write " << partPath << " to disk" << std::endl;
+            failure = AttemptFailure::local();
+            continue;
+        }
 
-        std::cout << std::endl; // Newline after progress bar
+        long response_code = 0;
+        curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &response_code);
 
         if (res != CURLE_OK) {
             std::cerr << "Download failed: " << curl_easy_strerror(res) << " (error code: " << res << ")" << std::endl;
@@ -418,37 +1330,44 @@ bool downloadFile(const std::string& url, const std::string& outputPath) {
                     break;
             }
 
-            // Clean up partial file
-            if (fs::exists(outputPath)) {
-                try {
-                    auto partialSize = fs::file_size(outputPath);
-                    std::cerr << "Partial download: " << (partialSize / (1024.0 * 1024.0)) << " MB" << std::endl;
-                    fs::remove(outputPath);
-                } catch (...) {}
+            // Keep the partial for the next attempt if it can be resumed safely
+            if (state.bytesWritten > 0 && !state.ifRangeValidator().empty() && state.save(statePath)) {
+                std::cerr << "Partial download kept: " << (state.bytesWritten / (1024.0 * 1024.0)) << " MB" << std::endl;
+            } else {
+                discardPartial(outputPath);
             }
 
-            if (attempt == MAX_RETRIES) {
-                std::cerr << "Max retries reached. Download failed." << std::endl;
-                return false;
-            }
+            failure = AttemptFailure::fromTransfer(curl.get(), res);
             continue;
         }
 
-        // Check HTTP response code
-        long response_code = 0;
-        curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &response_code);
+        if (response_code == 304) {
+            discardPartial(outputPath);
+            if (algorithm) {
+                // Reuse the digest recorded at download time; hash the local copy only if there is none
+                digest = cached.hashAlgorithm == hashKey(*algorithm) ? cached.digest
+                                                                       : computeFileHash(outputPath, *algorithm);
+                if (!expectedHash.empty() && !digestEquals(digest, expectedHash)) {
+                    std::cerr << "Local copy of " << filename << " does not match the expected "
+                             << hashAlgorithmName(*algorithm) << ", downloading again" << std::endl;
+                    digest.clear();
+                    haveCached = false;
+                    continue;
+                }
+            }
+            std::cout << "Not modified, keeping local copy: " << filename << std::endl;
+            return FetchStatus::NotModified;
+        }
 
+        // Check HTTP response code
         if (response_code >= 400) {
             std::cerr << "HTTP error " << response_code << " downloading " << url << std::endl;
 
-            // Clean up partial file
-            if (fs::exists(outputPath)) {
-                try {
-                    fs::remove(outputPath);
-                } catch (...) {}
-            }
-
-            if (attempt == MAX_RETRIES) return false;
+            // A range error means the stored offset no longer fits the remote file; starting
+            // over from zero can succeed, unlike other client errors
+            discardPartial(outputPath);
+            failure = response_code == 416 && writer.resumeFrom > 0 ? AttemptFailure::local()
+                                                                    : AttemptFailure::fromTransfer(curl.get(), res);
             continue;
         }
 
@@ -462,21 +1381,35 @@ bool downloadFile(const std::string& url, const std::string& outputPath) {
                  << (downloadSize / (1024.0 * 1024.0)) << " MB" << std::endl;
 
         // Check if file exists and has content
-        if (!fs::exists(outputPath)) {
+        if (!fs::exists(partPath)) {
             std::cerr << "ERROR: File does not exist after download!" << std::endl;
-            if (attempt == MAX_RETRIES) return false;
+            failure = AttemptFailure::local();
             continue;
         }
 
         try {
-            auto actualFileSize = fs::file_size(outputPath);
+            auto actualFileSize = fs::file_size(partPath);
 
             if (actualFileSize == 0) {
                 std::cerr << "Downloaded file is empty (0 bytes)" << std::endl;
-                if (fs::exists(outputPath)) {
-                    try { fs::remove(outputPath); } catch (...) {}
-                }
-                if (attempt == MAX_RETRIES) return false;
+                discardPartial(outputPath);
+                failure = AttemptFailure::local();
+                continue;
+            }
+
+            // A resumed transfer reports only the remaining length
+            const std::uint64_t expectedSize = contentLength > 0
+                ? static_cast<std::uint64_t>(contentLength) + writer.resumeFrom : 0;
+            if (expectedSize > 0 && actualFileSize != expectedSize) {
+                std::cerr << "Size mismatch: expected " << expectedSize
+                         << " bytes, got " << actualFileSize << " bytes" << std::endl;
+                discardPartial(outputPath);
+                failure = AttemptFailure::local();
+                continue;
+            }
+
+            if (!finishDownload(hash, state)) {
+                failure = AttemptFailure::local();
                 continue;
             }
 
@@ -494,20 +1427,600 @@ bool downloadFile(const std::string& url, const std::string& outputPath) {
 
             // Success! File exists and has content
             std::cout << "✓ Download completed successfully: " << filename << std::endl;
-            return true;
+            return FetchStatus::Downloaded;
 
         } catch (const fs::filesystem_error& e) {
             std::cerr << "Could not verify file: " << e.what() << std::endl;
-            if (attempt == MAX_RETRIES) return false;
+            failure = AttemptFailure::local();
             continue;
         } catch (const std::exception& e) {
             std::cerr << "Error reading file: " << e.what() << std::endl;
-            if (attempt == MAX_RETRIES) return false;
+            failure = AttemptFailure::local();
+            continue;
+        }
+    }
+
+}
+
+bool downloadFile(const std::string& url, const std::string& outputPath, TransferClass transferClass) {
+    std::string digest;
+    return fetchFile(url, outputPath, false, std::nullopt, "", digest, transferClass) == FetchStatus::Downloaded;
+}
+
+FetchStatus downloadFileIfModified(const std::string& url, const std::string& outputPath, TransferClass transferClass) {
+    std::string digest;
+    return fetchFile(url, outputPath, true, std::nullopt, "", digest, transferClass);
+}
+
+DownloadResult downloadFileVerified(const std::string& url, const std::string& outputPath,
+                                    HashAlgorithm algorithm, const std::string& expectedHash,
+                                    bool conditional, TransferClass transferClass) {
+    DownloadResult result;
+    result.status = fetchFile(url, outputPath, conditional, algorithm, expectedHash, result.digest, transferClass);
+    return result;
+}
+
+// Write target for downloadStreamed: the consumer plus the optional cached copy
+struct StreamWriter {
+    DownloadConsumer* consumer = nullptr;
+    FileSink* cache = nullptr;  // Null when no copy is kept
+    StreamingHash* hash = nullptr;
+    TransferProgress* progress = nullptr;
+    CURL* curl = nullptr;
+    TransferClass transferClass = TransferClass::Bulk;
+    bool started = false;
+    bool discardBody = false;   // Body of an error or 304 response, not part of the file
+    bool consumerFailed = false;
+};
+
+static size_t write_stream(const char* ptr, const size_t size, const size_t nmemb, void* userdata) {
+    auto* writer = static_cast<StreamWriter*>(userdata);
+    const size_t total = size * nmemb;
+
+    if (!writer->started) {
+        writer->started = true;
+        long response_code = 0;
+        curl_easy_getinfo(writer->curl, CURLINFO_RESPONSE_CODE, &response_code);
+        writer->discardBody = response_code != 200;
+
+        curl_off_t contentLength = 0;
+        curl_easy_getinfo(writer->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength);
+        if (!writer->discardBody && contentLength > 0) writer->progress->setExpected(static_cast<std::uint64_t>(contentLength));
+    }
+    if (writer->discardBody) return total;
+
+    if (!writer->consumer->consume(ptr, total)) {
+        writer->consumerFailed = true;
+        return 0;
+    }
+    if (writer->cache && write_data(ptr, total, *writer->cache) != total) return 0;
+    writer->hash->update(ptr, total);
+    writer->progress->add(total);
+    DownloadScheduler::getInstance().throttle(writer->transferClass, total);
+    return total;
+}
+
+// Push a file already on disk through a consumer as if it had just been downloaded
+static bool replayFile(const std::string& path, DownloadConsumer& consumer, HashAlgorithm algorithm,
+                       const std::string& expectedHash, std::string& digest) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open() || !consumer.begin()) return false;
+
+    StreamingHash hash(algorithm);
+    std::vector<char> buffer(FileSink::DEFAULT_BUFFER_SIZE);
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const size_t count = static_cast<size_t>(file.gcount());
+        if (count == 0) break;
+        hash.update(buffer.data(), count);
+        if (!consumer.consume(buffer.data(), count)) return false;
+    }
+    if (file.bad()) return false;
+
+    digest = hash.finish();
+    if (!expectedHash.empty() && !digestEquals(digest, expectedHash)) {
+        std::cerr << "Cached " << path << " does not match the expected " << hashAlgorithmName(algorithm) << std::endl;
+        digest.clear();
+        return false;
+    }
+    return consumer.finish();
+}
+
+DownloadResult downloadStreamed(const std::string& url, DownloadConsumer& consumer, HashAlgorithm algorithm,
+                                const std::string& expectedHash, const std::string& cachePath,
+                                TransferClass transferClass) {
+    DownloadResult result;
+    const std::string filename = fs::path(cachePath.empty() ? url : cachePath).filename().string();
+
+    // Validators of the cached copy, checked the same way fetchFile does
+    CachedValidators cached;
+    bool haveCached = false;
+    if (!cachePath.empty()) {
+        std::error_code ec;
+        if (const auto parent = fs::path(cachePath).parent_path(); !parent.empty()) {
+            fs::create_directories(parent, ec);
+        }
+        if (ValidatorCache::getInstance().lookup(url, cached)) {
+            haveCached = fs::exists(cachePath, ec) && (cached.size == 0 || fs::file_size(cachePath, ec) == cached.size);
+            if (haveCached && !expectedHash.empty() && cached.hashAlgorithm == hashKey(algorithm) &&
+                !digestEquals(cached.digest, expectedHash)) {
+                haveCached = false;
+            }
+        }
+
+        if (!expectedHash.empty() && ArtifactStore::getInstance().install(algorithm, expectedHash, cachePath)) {
+            std::cout << "Installed from artifact store: " << filename << std::endl;
+            if (replayFile(cachePath, consumer, algorithm, expectedHash, result.digest)) {
+                result.status = FetchStatus::Downloaded;
+                return result;
+            }
+        }
+    }
+
+    TransferSlot slot = DownloadScheduler::getInstance().acquire(transferClass);
+
+    RetryState retry(RetryPolicy::download());
+    std::optional<AttemptFailure> failure;
+    while (true) {
+        if (failure) {
+            if (!backoffBeforeRetry(retry, *failure, filename)) return result;
+            failure.reset();
+        }
+
+        if (!consumer.begin()) return result;
+
+        StreamingHash hash(algorithm);
+        FileSink cache;
+        if (!cachePath.empty()) {
+            discardPartial(cachePath);
+            if (!cache.open(partPathFor(cachePath), FileSink::Mode::Truncate)) {
+                std::cerr << "Failed to open file for writing: " << partPathFor(cachePath) << std::endl;
+                return result;
+            }
+        }
+
+        PooledCurlHandle curl;
+        if (!curl.isValid()) {
+            std::cerr << "Failed to initialize CURL" << std::endl;
+            failure = AttemptFailure::local();
+            continue;
+        }
+
+        TransferProgress progress = ProgressTracker::getInstance().begin(filename);
+        RemoteFileInfo response;
+        StreamWriter writer;
+        writer.consumer = &consumer;
+        writer.cache = cache.isOpen() ? &cache : nullptr;
+        writer.hash = &hash;
+        writer.progress = &progress;
+        writer.transferClass = transferClass;
+
+        CurlHeaderList headers;
+        if (haveCached) {
+            if (!cached.etag.empty()) headers.append("If-None-Match: " + cached.etag);
+            if (!cached.lastModified.empty()) headers.append("If-Modified-Since: " + cached.lastModified);
+        }
+
+        auto configure = [&](CURL* handle) {
+            curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+            curl_easy_setopt(handle, CURLOPT_MAXREDIRS, 10L);
+            curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, 30L);
+            curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, 120L);
+            curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, 512L);
+            curl_easy_setopt(handle, CURLOPT_USERAGENT, "PurrLauncher/2.4.104");
+            curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+            curl_easy_setopt(handle, CURLOPT_TCP_NODELAY, 1L);
+            curl_easy_setopt(handle, CURLOPT_BUFFERSIZE, 524288L);
+            curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 1L);
+            curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 2L);
+            curl_easy_setopt(handle, CURLOPT_HTTP_TRANSFER_DECODING, 1L);
+            if (headers.get()) curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers.get());
+        };
+
+        std::cout << "Streaming: " << filename << std::endl;
+
+        std::string sourceUrl;
+        const CURLcode res = performHedged(url, configure, {write_stream, &writer, &response, [&](CURL* handle) { writer.curl = handle; }},
+                                           curl, sourceUrl);
+        progress.finish();
+        if (sourceUrl != url) {
+            std::cout << "Streamed from mirror: " << sourceUrl << std::endl;
+        }
+        const bool closed = cache.close(res == CURLE_OK ? SyncPolicy::Fsync : SyncPolicy::Flush);
+
+        // The consumer rejected the data; retrying would only feed it the same bytes
+        if (writer.consumerFailed) {
+            if (!cachePath.empty()) discardPartial(cachePath);
+            std::cerr << "Stopped streaming " << filename << ": the consumer rejected the data" << std::endl;
+            return result;
+        }
+
+        long response_code = 0;
+        curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &response_code);
+
+        if (res != CURLE_OK || !closed) {
+            std::cerr << "Download failed: " << (res != CURLE_OK ? curl_easy_strerror(res) : "could not write the cached copy")
+                     << std::endl;
+            if (!cachePath.empty()) discardPartial(cachePath);
+            failure = res != CURLE_OK ? AttemptFailure::fromTransfer(curl.get(), res) : AttemptFailure::local();
+            continue;
+        }
+
+        if (response_code == 304) {
+            discardPartial(cachePath);
+            std::cout << "Not modified, extracting cached copy: " << filename << std::endl;
+            if (replayFile(cachePath, consumer, algorithm, expectedHash, result.digest)) {
+                result.status = FetchStatus::NotModified;
+                return result;
+            }
+            haveCached = false; // Unusable cached copy: fetch it in full
+            continue;
+        }
+
+        if (response_code != 200) {
+            std::cerr << "HTTP error " << response_code << " downloading " << url << std::endl;
+            if (!cachePath.empty()) discardPartial(cachePath);
+            failure = AttemptFailure::fromTransfer(curl.get(), res);
+            continue;
+        }
+
+        result.digest = hash.finish();
+        if (!expectedHash.empty() && !digestEquals(result.digest, expectedHash)) {
+            std::cerr << hashAlgorithmName(algorithm) << " mismatch for " << filename << ": expected "
+                     << expectedHash << ", got " << result.digest << std::endl;
+            result.digest.clear();
+            if (!cachePath.empty()) discardPartial(cachePath);
+            failure = AttemptFailure::local();
+            continue;
+        }
+
+        if (!consumer.finish()) {
+            if (!cachePath.empty()) discardPartial(cachePath);
+            return result;
+        }
+
+        if (!cachePath.empty() && commitPartial(cachePath)) {
+            if (!response.etag.empty() || !response.lastModified.empty()) {
+                std::error_code ec;
+                const auto size = fs::file_size(cachePath, ec);
+                ValidatorCache::getInstance().store(url, {response.etag, response.lastModified, ec ? 0 : size,
+                                                          hashKey(algorithm), result.digest});
+            }
+            ArtifactStore::getInstance().add(algorithm, result.digest, cachePath);
+        }
+
+        std::cout << "✓ Download completed successfully: " << filename << std::endl;
+        result.status = FetchStatus::Downloaded;
+        return result;
+    }
+}
+
+// In-flight transfer belonging to a batch
+struct BatchTransfer {
+    size_t jobIndex = 0;
+    RetryState retry;
+    PooledCurlHandle curl;
+    std::unique_ptr<FileSink> file;
+    StreamingHash hash;
+    TransferClass transferClass;
+    TransferSlot slot;
+    TransferProgress progress;
+    RateHold rateHold;
+    std::string mirrorBase;    // Mirror this attempt was sent to
+    bool moreMirrors = false;  // Another mirror can still be tried after this one
+    bool started = false;
+
+    BatchTransfer(const RetryState& state, HashAlgorithm algorithm, TransferClass cls)
+        : retry(state), hash(algorithm), transferClass(cls) {}
+};
+
+static size_t write_batch(const char* ptr, const size_t size, const size_t nmemb, void* userdata) {
+    auto* transfer = static_cast<BatchTransfer*>(userdata);
+    if (transfer->rateHold.holding()) return CURL_WRITEFUNC_PAUSE;
+    if (!transfer->started) {
+        transfer->started = true;
+        curl_off_t contentLength = 0;
+        curl_easy_getinfo(transfer->curl.get(), CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength);
+        if (contentLength > 0) transfer->progress.setExpected(static_cast<std::uint64_t>(contentLength));
+    }
+
+    const size_t written = write_data(ptr, size * nmemb, *transfer->file);
+    transfer->hash.update(ptr, written);
+    transfer->progress.add(written);
+    transfer->rateHold.charge(transfer->transferClass, written);
+    return written;
+}
+
+// Job waiting for a free slot, possibly delayed after a failed attempt
+struct PendingJob {
+    size_t jobIndex;
+    RetryState retry;
+    std::chrono::steady_clock::time_point notBefore;
+};
+
+static HashAlgorithm jobHashAlgorithm(const DownloadJob& job) {
+    return job.sha256.empty() ? HashAlgorithm::SHA1 : HashAlgorithm::SHA256;
+}
+
+static const std::string& jobExpectedHash(const DownloadJob& job) {
+    return job.sha256.empty() ? job.sha1 : job.sha256;
+}
+
+// Check whether a job's target already exists with the expected size and hash
+static bool isJobSatisfied(const DownloadJob& job, std::string& digest) {
+    try {
+        if (!fs::exists(job.outputPath)) return false;
+        if (job.expectedSize > 0 && fs::file_size(job.outputPath) != job.expectedSize) return false;
+    } catch (const fs::filesystem_error&) {
+        return false;
+    }
+
+    if (jobExpectedHash(job).empty()) return true;
+    digest = computeFileHash(job.outputPath, jobHashAlgorithm(job));
+    return digestEquals(digest, jobExpectedHash(job));
+}
+
+// Verify a finished batch transfer against the digest computed while it streamed,
+// returning an error description or empty on success
+static std::string verifyBatchResult(const DownloadJob& job, const std::string& digest) {
+    try {
+        const auto actualSize = fs::file_size(job.outputPath);
+        if (actualSize == 0) {
+            return "file is empty";
+        }
+        if (job.expectedSize > 0 && actualSize != job.expectedSize) {
+            return "size mismatch (expected " + std::to_string(job.expectedSize) +
+                   " bytes, got " + std::to_string(actualSize) + ")";
+        }
+    } catch (const fs::filesystem_error& e) {
+        return e.what();
+    }
+
+    if (const std::string& expected = jobExpectedHash(job); !expected.empty() && !digestEquals(digest, expected)) {
+        return std::string(hashAlgorithmName(jobHashAlgorithm(job))) + " mismatch (expected " + expected +
+               ", got " + digest + ")";
+    }
+    return "";
+}
+
+static void configureBatchHandle(CURL* curl, const std::string& url, WriteCallback write, void* writeData) {
+    HttpClient::getInstance().setUrl(curl, url);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, writeData);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, writeData);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 10L);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L);
+
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 60L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 512L);
+
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "PurrLauncher/2.4.104");
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+}
+
+DownloadReport downloadBatch(const std::vector<DownloadJob>& jobs, int maxConcurrent, int maxRetries,
+                             TransferClass transferClass) {
+    constexpr int POLL_TIMEOUT_MS = 200;
+
+    DownloadReport report;
+    const auto startTime = std::chrono::steady_clock::now();
+    maxConcurrent = std::max(maxConcurrent, 1);
+    RetryPolicy retryPolicy = RetryPolicy::download();
+    retryPolicy.maxAttempts = maxRetries;
+
+    // Skip jobs whose target is already in place
+    std::deque<PendingJob> pending;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        if (std::string digest; isJobSatisfied(jobs[i], digest)) {
+            ++report.skipped;
+            if (!digest.empty()) report.digests[jobs[i].outputPath] = digest;
+        } else if (const std::string& expected = jobExpectedHash(jobs[i]);
+                   !expected.empty() && ArtifactStore::getInstance().install(jobHashAlgorithm(jobs[i]), expected,
+                                                                             jobs[i].outputPath, jobs[i].expectedSize)) {
+            ++report.fromStore;
+            report.digests[jobs[i].outputPath] = expected;
+        } else {
+            pending.push_back({i, RetryState(retryPolicy), startTime});
+        }
+    }
+
+    CurlMultiHandle multi;
+    if (!pending.empty() && !multi.isValid()) {
+        std::cerr << "Failed to initialize CURL multi handle" << std::endl;
+        for (const auto& job : pending) {
+            report.failedPaths.push_back(jobs[job.jobIndex].outputPath);
+        }
+        report.failed = pending.size();
+        return report;
+    }
+
+    // Show the size of the whole batch from the start, not just of the transfers in flight
+    std::uint64_t queuedBytes = 0;
+    for (const auto& job : pending) queuedBytes += jobs[job.jobIndex].expectedSize;
+    ProgressReservation queuedProgress = ProgressTracker::getInstance().reserve(queuedBytes);
+
+    std::unordered_map<CURL*, std::unique_ptr<BatchTransfer>> active;
+
+    // Record a failed attempt and either requeue the job or give up on it
+    auto failAttempt = [&](size_t jobIndex, RetryState retry, const AttemptFailure& failure, const std::string& reason) {
+        const DownloadJob& job = jobs[jobIndex];
+        std::cerr << "\nDownload failed: " << fs::path(job.outputPath).filename().string()
+                 << " (attempt " << retry.attempt() << "/" << retry.maxAttempts() << "): " << reason << std::endl;
+
+        try {
+            if (fs::exists(job.outputPath)) fs::remove(job.outputPath);
+        } catch (const fs::filesystem_error&) {}
+
+        std::chrono::milliseconds delay{0};
+        if (const RetryDecision decision = retry.next(failure, delay); decision == RetryDecision::Retry) {
+            pending.push_back({jobIndex, retry, std::chrono::steady_clock::now() + delay});
+        } else {
+            if (decision != RetryDecision::OutOfAttempts) std::cerr << "Giving up: " << retryDecisionText(decision) << std::endl;
+            ++report.failed;
+            report.failedPaths.push_back(job.outputPath);
+        }
+    };
+
+    auto startTransfer = [&](const PendingJob& next, TransferSlot slot) {
+        if (next.retry.attempt() == 1) queuedProgress.take(jobs[next.jobIndex].expectedSize);
+        const DownloadJob& job = jobs[next.jobIndex];
+
+        if (const auto parent = fs::path(job.outputPath).parent_path(); !parent.empty()) {
+            try {
+                fs::create_directories(parent);
+            } catch (const fs::filesystem_error& e) {
+                failAttempt(next.jobIndex, next.retry, AttemptFailure::local(), e.what());
+                return;
+            }
+        }
+
+        auto transfer = std::make_unique<BatchTransfer>(next.retry, jobHashAlgorithm(job), transferClass);
+        transfer->slot = std::move(slot);
+        transfer->jobIndex = next.jobIndex;
+        if (!transfer->curl.isValid()) {
+            failAttempt(next.jobIndex, next.retry, AttemptFailure::local(), "failed to initialize CURL");
+            return;
+        }
+
+        // Unlink first: the old file may be a hardlink into the artifact store and must not be truncated
+        std::error_code removeError;
+        fs::remove(job.outputPath, removeError);
+        // Library-sized files: a smaller buffer keeps many parallel transfers cheap
+        transfer->file = std::make_unique<FileSink>(BATCH_SINK_BUFFER_SIZE);
+        if (!transfer->file->open(job.outputPath, FileSink::Mode::Truncate)) {
+            failAttempt(next.jobIndex, next.retry, AttemptFailure::local(), "failed to open file for writing");
+            return;
+        }
+        if (job.expectedSize > 0) transfer->file->preallocate(job.expectedSize);
+        transfer->progress = ProgressTracker::getInstance().begin(fs::path(job.outputPath).filename().string());
+        transfer->progress.setExpected(job.expectedSize);
+
+        // Batches spread over many handles already, so each attempt goes to the best ranked mirror
+        // alone; a failure demotes it, which sends the retry to the next one
+        const std::vector<MirrorCandidate> candidates = MirrorRegistry::getInstance().candidates(job.url);
+        transfer->mirrorBase = candidates.front().base;
+        transfer->moreMirrors = static_cast<size_t>(next.retry.attempt()) < candidates.size();
+
+        configureBatchHandle(transfer->curl.get(), candidates.front().url, write_batch, transfer.get());
+        CURL* handle = transfer->curl.get();
+        if (curl_multi_add_handle(multi.get(), handle) != CURLM_OK) {
+            transfer->file->close();
+            failAttempt(next.jobIndex, next.retry, AttemptFailure::local(), "failed to queue transfer");
+            return;
+        }
+        active.emplace(handle, std::move(transfer));
+    };
+
+    auto finishTransfer = [&](CURL* handle, CURLcode result) {
+        auto it = active.find(handle);
+        if (it == active.end()) return;
+
+        std::unique_ptr<BatchTransfer> transfer = std::move(it->second);
+        active.erase(it);
+        curl_multi_remove_handle(multi.get(), handle);
+        HttpClient::getInstance().recordTransfer(handle);
+        MirrorRegistry::getInstance().record(transfer->mirrorBase, mirrorSample(handle, result));
+        transfer->progress.finish();
+        const bool closed = transfer->file->close();
+
+        const DownloadJob& job = jobs[transfer->jobIndex];
+        if (result == CURLE_OK && !closed) {
+            failAttempt(transfer->jobIndex, transfer->retry, AttemptFailure::local(), "failed to write file to disk");
+            return;
+        }
+        if (result != CURLE_OK) {
+            long responseCode = 0;
+            curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &responseCode);
+            std::string reason = curl_easy_strerror(result);
+            if (responseCode >= 400) reason += " (HTTP " + std::to_string(responseCode) + ")";
+            AttemptFailure failure = AttemptFailure::fromTransfer(handle, result);
+            // A 404 from one mirror says nothing about the others
+            if (failure.permanent() && transfer->moreMirrors) failure = AttemptFailure::local();
+            failAttempt(transfer->jobIndex, transfer->retry, failure, reason);
+            return;
+        }
+
+        const std::string digest = transfer->hash.finish();
+        if (const std::string error = verifyBatchResult(job, digest); !error.empty()) {
+            failAttempt(transfer->jobIndex, transfer->retry, AttemptFailure::local(), error);
+            return;
+        }
+        report.digests[job.outputPath] = digest;
+        ArtifactStore::getInstance().add(jobHashAlgorithm(job), digest, job.outputPath);
+
+        curl_off_t downloaded = 0;
+        curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+        report.bytesDownloaded += static_cast<std::uint64_t>(downloaded);
+        ++report.succeeded;
+    };
+
+    while (!pending.empty() || !active.empty()) {
+        // Fill free slots with jobs whose retry delay has elapsed
+        const auto now = std::chrono::steady_clock::now();
+        for (auto it = pending.begin();
+             it != pending.end() && active.size() < static_cast<size_t>(maxConcurrent);) {
+            if (it->notBefore > now) {
+                ++it;
+                continue;
+            }
+            TransferSlot slot = DownloadScheduler::getInstance().tryAcquire(transferClass);
+            if (!slot) break; // Class cap reached; try again once a transfer finishes
+            const PendingJob next = *it;
+            it = pending.erase(it);
+            startTransfer(next, std::move(slot));
+            it = pending.begin(); // startTransfer may have requeued a failed job
+        }
+
+        if (active.empty()) {
+            if (!pending.empty()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(POLL_TIMEOUT_MS));
+            }
             continue;
         }
+
+        int running = 0;
+        if (curl_multi_perform(multi.get(), &running) != CURLM_OK) {
+            std::cerr << "CURL multi perform failed" << std::endl;
+        }
+
+        int queued = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi.get(), &queued)) {
+            if (msg->msg == CURLMSG_DONE) {
+                finishTransfer(msg->easy_handle, msg->data.result);
+            }
+        }
+
+        if (!active.empty()) {
+            const auto polled = std::chrono::steady_clock::now();
+            auto wakeAt = std::chrono::steady_clock::time_point::max();
+            for (auto& [handle, transfer] : active) {
+                transfer->rateHold.resumeIfDue(handle, polled, wakeAt);
+            }
+            curl_multi_poll(multi.get(), nullptr, 0, pollTimeout(POLL_TIMEOUT_MS, polled, wakeAt), nullptr);
+        }
     }
 
-    return false;
+    queuedProgress.release();
+    report.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::cout << "Batch download finished: " << report.succeeded << " downloaded, "
+             << report.skipped << " up to date, " << report.fromStore << " from store, "
+             << report.failed << " failed ("
+             << std::fixed << std::setprecision(2) << (report.bytesDownloaded / (1024.0 * 1024.0))
+             << " MB in " << report.elapsedSeconds << " s)" << std::endl;
+    for (const auto& path : report.failedPaths) {
+        std::cerr << "  Failed: " << path << std::endl;
+    }
+
+    return report;
 }
 
 static size_t write_callback(const char* ptr, const size_t size, const size_t nmemb, void* userdata) {
@@ -516,18 +2029,22 @@ static size_t write_callback(const char* ptr, const size_t size, const size_t nm
     return size * nmemb;
 }
 
-std::string httpGet(const std::string& url) {
-    constexpr int MAX_RETRIES = 3;
+// Small JSON bodies: admitted by class, but not counted against the rate limit
+std::string httpGet(const std::string& url, TransferClass transferClass) {
+    TransferSlot slot = DownloadScheduler::getInstance().acquire(transferClass);
 
-    for (int attempt = 1; attempt <= MAX_RETRIES; ++attempt) {
-        if (attempt > 1) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+    RetryState retry(RetryPolicy::api());
+    std::optional<AttemptFailure> failure;
+    while (true) {
+        if (failure) {
+            if (!backoffBeforeRetry(retry, *failure, "HTTP GET")) return "";
+            failure.reset();
         }
 
-        CurlHandle curl;
+        PooledCurlHandle curl;
         if (!curl.isValid()) {
             std::cerr << "Failed to initialize CURL for GET request" << std::endl;
-            if (attempt == MAX_RETRIES) return "";
+            failure = AttemptFailure::local();
             continue;
         }
 
@@ -540,18 +2057,21 @@ std::string httpGet(const std::string& url) {
         curl_easy_setopt(curl.get(), CURLOPT_FOLLOWLOCATION, 1L);
         curl_easy_setopt(curl.get(), CURLOPT_MAXREDIRS, 5L);
         curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, 15L);
-        curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, 30L);
+        // Each attempt also stops at the operation's deadline
+        curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT_MS,
+                         static_cast<long>(std::clamp<long long>(retry.remaining().count(), 1, 30000)));
         curl_easy_setopt(curl.get(), CURLOPT_USERAGENT, "PurrLauncher/2.4.104");
         curl_easy_setopt(curl.get(), CURLOPT_ACCEPT_ENCODING, "");
         curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYPEER, 1L);
         curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYHOST, 2L);
 
         CURLcode res = curl_easy_perform(curl.get());
+        HttpClient::getInstance().recordTransfer(curl.get());
 
         if (res != CURLE_OK) {
-            std::cerr << "HTTP GET failed (attempt " << attempt << "): "
+            std::cerr << "HTTP GET failed (attempt " << retry.attempt() << "): "
                      << curl_easy_strerror(res) << std::endl;
-            if (attempt == MAX_RETRIES) return "";
+            failure = AttemptFailure::fromTransfer(curl.get(), res);
             continue;
         }
 
@@ -560,43 +2080,36 @@ std::string httpGet(const std::string& url) {
 
         if (http_code < 200 || http_code >= 300) {
             std::cerr << "HTTP GET failed with code " << http_code
-                     << " (attempt " << attempt << ")" << std::endl;
-            if (attempt == MAX_RETRIES) return "";
+                     << " (attempt " << retry.attempt() << ")" << std::endl;
+            failure = AttemptFailure::fromTransfer(curl.get(), res);
             continue;
         }
 
         return response;
     }
-
-    return "";
 }
 
-std::string httpPost(const std::string& url, const std::string& jsonData) {
-    constexpr int MAX_RETRIES = 3;
+std::string httpPost(const std::string& url, const std::string& jsonData, TransferClass transferClass) {
+    TransferSlot slot = DownloadScheduler::getInstance().acquire(transferClass);
 
-    for (int attempt = 1; attempt <= MAX_RETRIES; ++attempt) {
-        if (attempt > 1) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+    RetryState retry(RetryPolicy::api());
+    std::optional<AttemptFailure> failure;
+    while (true) {
+        if (failure) {
+            if (!backoffBeforeRetry(retry, *failure, "HTTP POST")) return "";
+            failure.reset();
         }
 
-        CurlHandle curl;
+        PooledCurlHandle curl;
         if (!curl.isValid()) {
             std::cerr << "Failed to initialize CURL for POST request" << std::endl;
-            if (attempt == MAX_RETRIES) return "";
+            failure = AttemptFailure::local();
             continue;
         }
 
-        // RAII for curl_slist
-        struct curl_slist* headers = nullptr;
-        headers = curl_slist_append(headers, "Content-Type: application/json");
-        headers = curl_slist_append(headers, "Accept: application/json");
-
-        auto cleanup_headers = [&headers]() {
-            if (headers) {
-                curl_slist_free_all(headers);
-                headers = nullptr;
-            }
-        };
+        CurlHeaderList headers;
+        headers.append("Content-Type: application/json");
+        headers.append("Accept: application/json");
 
         std::string response;
         response.reserve(4096);
@@ -604,24 +2117,26 @@ std::string httpPost(const std::string& url, const std::string& jsonData) {
         curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
         curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, jsonData.c_str());
         curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDSIZE, static_cast<long>(jsonData.length()));
-        curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, headers);
+        curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, headers.get());
         curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, write_callback);
         curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &response);
         curl_easy_setopt(curl.get(), CURLOPT_FOLLOWLOCATION, 1L);
         curl_easy_setopt(curl.get(), CURLOPT_MAXREDIRS, 5L);
         curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, 15L);
-        curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, 30L);
+        // Each attempt also stops at the operation's deadline
+        curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT_MS,
+                         static_cast<long>(std::clamp<long long>(retry.remaining().count(), 1, 30000)));
         curl_easy_setopt(curl.get(), CURLOPT_USERAGENT, "PurrLauncher/2.4.104");
         curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYPEER, 1L);
         curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYHOST, 2L);
 
         CURLcode res = curl_easy_perform(curl.get());
-        cleanup_headers();
+        HttpClient::getInstance().recordTransfer(curl.get());
 
         if (res != CURLE_OK) {
-            std::cerr << "HTTP POST failed (attempt " << attempt << "): "
+            std::cerr << "HTTP POST failed (attempt " << retry.attempt() << "): "
                      << curl_easy_strerror(res) << std::endl;
-            if (attempt == MAX_RETRIES) return "";
+            failure = AttemptFailure::fromTransfer(curl.get(), res);
             continue;
         }
 
@@ -630,13 +2145,217 @@ std::string httpPost(const std::string& url, const std::string& jsonData) {
 
         if (http_code < 200 || http_code >= 300) {
             std::cerr << "HTTP POST failed with code " << http_code
-                     << " (attempt " << attempt << ")" << std::endl;
-            if (attempt == MAX_RETRIES) return "";
+                     << " (attempt " << retry.attempt() << ")" << std::endl;
+            failure = AttemptFailure::fromTransfer(curl.get(), res);
             continue;
         }
 
         return response;
     }
+}
 
-    return "";
-}
\ No newline at end of file
+// GET or POST of a small body on the event loop, with the same options and retries as
+// httpGet/httpPost; the future receives "" once every attempt failed
+class AsyncRequest : public AsyncTransfer {
+private:
+    std::string url;
+    std::optional<std::string> postData;  // POST when set
+    CurlHeaderList headers;
+    std::string response;
+    std::promise<std::string> promise;
+
+public:
+    AsyncRequest(const std::string& requestUrl, std::optional<std::string> jsonData, TransferClass transferClass)
+        : AsyncTransfer(transferClass, RetryPolicy::api()), url(requestUrl), postData(std::move(jsonData)) {
+        if (postData) {
+            headers.append("Content-Type: application/json");
+            headers.append("Accept: application/json");
+        }
+    }
+
+    std::future<std::string> future() { return promise.get_future(); }
+
+    std::string describe() const override { return postData ? "HTTP POST" : "HTTP GET"; }
+
+    bool begin(CURL* curl) override {
+        response.clear();
+        response.reserve(4096);
+
+        HttpClient::getInstance().setUrl(curl, url);
+        if (postData) {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postData->c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(postData->length()));
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers.get());
+        } else {
+            curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+        }
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 5L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 15L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS,
+                         static_cast<long>(std::clamp<long long>(retry.remaining().count(), 1, 30000)));
+        curl_easy_setopt(curl, CURLOPT_USERAGENT, "PurrLauncher/2.4.104");
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+        return true;
+    }
+
+    std::optional<AttemptFailure> end(CURL* curl, CURLcode result) override {
+        if (result != CURLE_OK) {
+            std::cerr << describe() << " failed (attempt " << retry.attempt() << "): " << curl_easy_strerror(result) << std::endl;
+            return AttemptFailure::fromTransfer(curl, result);
+        }
+
+        long http_code = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+        if (http_code < 200 || http_code >= 300) {
+            std::cerr << describe() << " failed with code " << http_code << " (attempt " << retry.attempt() << ")" << std::endl;
+            return AttemptFailure::fromTransfer(curl, result);
+        }
+
+        promise.set_value(std::move(response));
+        return std::nullopt;
+    }
+
+    void abandon() override { promise.set_value(""); }
+};
+
+// One batch-style job on the event loop: written in place, checked against its size and hash
+class AsyncDownload : public AsyncTransfer {
+private:
+    DownloadJob job;
+    std::unique_ptr<FileSink> file;
+    std::optional<StreamingHash> hash;
+    TransferProgress progress;
+    std::string mirrorBase;
+    bool moreMirrors = false;
+    std::promise<DownloadResult> promise;
+
+    static size_t write(const char* ptr, const size_t size, const size_t nmemb, void* userdata) {
+        auto* download = static_cast<AsyncDownload*>(userdata);
+        const size_t written = write_data(ptr, size * nmemb, *download->file);
+        download->hash->update(ptr, written);
+        download->progress.add(written);
+        // No throttle(): waiting for rate-limit tokens here would stall every other request on the loop
+        return written;
+    }
+
+    // Drop whatever an attempt wrote; nothing was written if no attempt began
+    void discard() {
+        progress.finish();
+        if (!file) return;
+        file->close();
+        std::error_code ec;
+        fs::remove(job.outputPath, ec);
+    }
+
+public:
+    AsyncDownload(const DownloadJob& downloadJob, TransferClass transferClass)
+        : AsyncTransfer(transferClass, RetryPolicy::download()), job(downloadJob) {}
+
+    std::future<DownloadResult> future() { return promise.get_future(); }
+
+    std::string describe() const override { return fs::path(job.outputPath).filename().string(); }
+
+    bool begin(CURL* curl) override {
+        std::error_code ec;
+        if (const auto parent = fs::path(job.outputPath).parent_path(); !parent.empty()) {
+            fs::create_directories(parent, ec);
+        }
+        // Unlink first: the old file may be a hardlink into the artifact store and must not be truncated
+        fs::remove(job.outputPath, ec);
+        file = std::make_unique<FileSink>(BATCH_SINK_BUFFER_SIZE);
+        if (!file->open(job.outputPath, FileSink::Mode::Truncate)) {
+            std::cerr << "Failed to open file for writing: " << job.outputPath << std::endl;
+            return false;
+        }
+        if (job.expectedSize > 0) file->preallocate(job.expectedSize);
+        hash.emplace(jobHashAlgorithm(job));
+        progress = ProgressTracker::getInstance().begin(describe());
+        progress.setExpected(job.expectedSize);
+
+        const std::vector<MirrorCandidate> candidates = MirrorRegistry::getInstance().candidates(job.url);
+        mirrorBase = candidates.front().base;
+        moreMirrors = static_cast<size_t>(retry.attempt()) < candidates.size();
+        configureBatchHandle(curl, candidates.front().url, write, this);
+        return true;
+    }
+
+    std::optional<AttemptFailure> end(CURL* curl, CURLcode result) override {
+        MirrorRegistry::getInstance().record(mirrorBase, mirrorSample(curl, result));
+        progress.finish();
+        const bool closed = file->close();
+
+        std::string reason;
+        std::optional<AttemptFailure> failure;
+        if (result != CURLE_OK) {
+            long responseCode = 0;
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+            reason = curl_easy_strerror(result);
+            if (responseCode >= 400) reason += " (HTTP " + std::to_string(responseCode) + ")";
+            failure = AttemptFailure::fromTransfer(curl, result);
+            if (failure->permanent() && moreMirrors) failure = AttemptFailure::local();
+        } else if (!closed) {
+            reason = "failed to write file to disk";
+            failure = AttemptFailure::local();
+        }
+
+        std::string digest;
+        if (!failure) {
+            digest = hash->finish();
+            reason = verifyBatchResult(job, digest);
+            if (!reason.empty()) failure = AttemptFailure::local();
+        }
+        if (failure) {
+            std::cerr << "\nDownload failed: " << describe() << " (attempt " << retry.attempt() << "/"
+                     << retry.maxAttempts() << "): " << reason << std::endl;
+            discard();
+            return failure;
+        }
+
+        ArtifactStore::getInstance().add(jobHashAlgorithm(job), digest, job.outputPath);
+        promise.set_value({FetchStatus::Downloaded, digest});
+        return std::nullopt;
+    }
+
+    void abandon() override {
+        discard();
+        promise.set_value({});
+    }
+};
+
+std::future<std::string> httpGetAsync(const std::string& url, TransferClass transferClass) {
+    auto request = std::make_unique<AsyncRequest>(url, std::nullopt, transferClass);
+    std::future<std::string> result = request->future();
+    HttpEventLoop::getInstance().submit(std::move(request));
+    return result;
+}
+
+std::future<std::string> httpPostAsync(const std::string& url, const std::string& jsonData, TransferClass transferClass) {
+    auto request = std::make_unique<AsyncRequest>(url, jsonData, transferClass);
+    std::future<std::string> result = request->future();
+    HttpEventLoop::getInstance().submit(std::move(request));
+    return result;
+}
+
+std::future<DownloadResult> downloadAsync(const DownloadJob& job, TransferClass transferClass) {
+    // Settled right here when no transfer is needed, as downloadBatch would skip the job
+    if (std::string digest; isJobSatisfied(job, digest)) {
+        std::promise<DownloadResult> ready;
+        ready.set_value({FetchStatus::NotModified, digest});
+        return ready.get_future();
+    }
+    if (const std::string& expected = jobExpectedHash(job);
+        !expected.empty() && ArtifactStore::getInstance().install(jobHashAlgorithm(job), expected, job.outputPath, job.expectedSize)) {
+        std::promise<DownloadResult> ready;
+        ready.set_value({FetchStatus::Downloaded, expected});
+        return ready.get_future();
+    }
+
+    auto download = std::make_unique<AsyncDownload>(job, transferClass);
+    std::future<DownloadResult> result = download->future();
+    HttpEventLoop::getInstance().submit(std::move(download));
+    return result;
+}
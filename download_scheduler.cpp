@@ -0,0 +1,161 @@
+#include "include/download_scheduler.h"
+#include <algorithm>
+#include <cmath>
+
+const char* transferClassName(TransferClass transferClass) {
+    switch (transferClass) {
+        case TransferClass::Auth: return "auth";
+        case TransferClass::Manifest: return "manifest";
+        case TransferClass::Library: return "libraries";
+        case TransferClass::Bulk: return "bulk";
+    }
+    return "unknown";
+}
+
+static size_t classIndex(TransferClass transferClass) {
+    return static_cast<size_t>(transferClass);
+}
+
+void TransferSlot::release() {
+    if (scheduler) {
+        scheduler->release(transferClass);
+        scheduler = nullptr;
+    }
+}
+
+DownloadScheduler& DownloadScheduler::getInstance() {
+    static DownloadScheduler instance;
+    return instance;
+}
+
+void DownloadScheduler::configure(const SchedulerSettings& newSettings) {
+    std::lock_guard<std::mutex> lock(mutex);
+    settings = newSettings;
+    settings.maxConcurrent = std::max<size_t>(settings.maxConcurrent, 1);
+    for (auto& limit : settings.classLimits) {
+        limit = std::max<size_t>(limit, 1);
+    }
+    tokens = 0.0;
+    lastRefill = std::chrono::steady_clock::now();
+    changed.notify_all();
+}
+
+bool DownloadScheduler::higherSlotWaiting(TransferClass transferClass) const {
+    // A waiter held back by its own class limit cannot use the slot, so it does not block lower classes
+    for (size_t i = 0; i < classIndex(transferClass); ++i) {
+        if (slotWaiters[i] > 0 && active[i] < settings.classLimits[i]) return true;
+    }
+    return false;
+}
+
+bool DownloadScheduler::higherTokenWaiting(TransferClass transferClass) const {
+    for (size_t i = 0; i < classIndex(transferClass); ++i) {
+        if (tokenWaiters[i] > 0) return true;
+    }
+    return false;
+}
+
+bool DownloadScheduler::canAdmit(TransferClass transferClass) const {
+    const size_t index = classIndex(transferClass);
+    if (active[index] >= settings.classLimits[index]) return false;
+
+    // Auth calls are tiny and latency-critical, so they may exceed the global cap
+    if (transferClass == TransferClass::Auth) return true;
+    return totalActive < settings.maxConcurrent && !higherSlotWaiting(transferClass);
+}
+
+TransferSlot DownloadScheduler::acquire(TransferClass transferClass) {
+    std::unique_lock<std::mutex> lock(mutex);
+    const size_t index = classIndex(transferClass);
+
+    ++slotWaiters[index];
+    changed.wait(lock, [&] { return canAdmit(transferClass); });
+    --slotWaiters[index];
+
+    ++active[index];
+    ++totalActive;
+    changed.notify_all(); // Lower classes may have been held back only by our waiting
+    return TransferSlot(this, transferClass);
+}
+
+TransferSlot DownloadScheduler::tryAcquire(TransferClass transferClass) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!canAdmit(transferClass)) return TransferSlot();
+
+    ++active[classIndex(transferClass)];
+    ++totalActive;
+    return TransferSlot(this, transferClass);
+}
+
+void DownloadScheduler::release(TransferClass transferClass) {
+    std::lock_guard<std::mutex> lock(mutex);
+    --active[classIndex(transferClass)];
+    --totalActive;
+    changed.notify_all();
+}
+
+void DownloadScheduler::refill() {
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+    lastRefill = now;
+
+    // Allow bursts of a quarter second so an idle bucket doesn't unleash a flood
+    const double rate = static_cast<double>(settings.rateLimitBytesPerSecond);
+    tokens = std::min(tokens + elapsed * rate, rate / 4.0);
+}
+
+void DownloadScheduler::throttle(TransferClass transferClass, size_t bytes) {
+    if (transferClass == TransferClass::Auth || bytes == 0) return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (settings.rateLimitBytesPerSecond == 0) return;
+
+    const size_t index = classIndex(transferClass);
+    ++tokenWaiters[index];
+    for (;;) {
+        refill();
+        if (tokens >= 0.0) {
+            if (!higherTokenWaiting(transferClass)) {
+                // Tokens may go negative: large chunks are paid for by the next caller's wait
+                tokens -= static_cast<double>(bytes);
+                break;
+            }
+            // The bucket can pay now; wake the higher class instead of leaving it to its timeout
+            changed.notify_all();
+        }
+
+        const double rate = static_cast<double>(settings.rateLimitBytesPerSecond);
+        const double deficit = tokens < 0.0 ? -tokens : 0.0;
+        const auto wait = std::chrono::duration<double>(std::clamp(deficit / rate, 0.001, 0.1));
+        changed.wait_for(lock, std::chrono::duration_cast<std::chrono::microseconds>(wait));
+    }
+    --tokenWaiters[index];
+    changed.notify_all();
+}
+
+std::chrono::milliseconds DownloadScheduler::charge(TransferClass transferClass, size_t bytes) {
+    constexpr auto YIELD_TO_HIGHER = std::chrono::milliseconds(100);
+
+    if (transferClass == TransferClass::Auth || bytes == 0) return std::chrono::milliseconds(0);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (settings.rateLimitBytesPerSecond == 0) return std::chrono::milliseconds(0);
+
+    refill();
+    tokens -= static_cast<double>(bytes);
+
+    // Paid for by holding off until the bucket is back above zero
+    const double rate = static_cast<double>(settings.rateLimitBytesPerSecond);
+    const double deficit = tokens < 0.0 ? -tokens : 0.0;
+    auto wait = std::chrono::milliseconds(static_cast<long long>(std::ceil(deficit * 1000.0 / rate)));
+    if (higherTokenWaiting(transferClass)) {
+        if (tokens < 0.0) {
+            // The bucket is in debt, so a higher class blocked in throttle() gets the refill first
+            wait = std::max(wait, YIELD_TO_HIGHER);
+        } else {
+            // Still enough left for it to go ahead at once
+            changed.notify_all();
+        }
+    }
+    return wait;
+}
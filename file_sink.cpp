@@ -0,0 +1,229 @@
+#include "include/file_sink.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Page alignment keeps the buffer usable for unbuffered/direct I/O
+constexpr size_t BUFFER_ALIGNMENT = 4096;
+
+void FileSink::AlignedDelete::operator()(char* p) const {
+    ::operator delete[](p, std::align_val_t(BUFFER_ALIGNMENT));
+}
+
+FileSink::FileSink(size_t size)
+    : bufferSize((std::max(size, BUFFER_ALIGNMENT) + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT * BUFFER_ALIGNMENT) {}
+
+FileSink::~FileSink() {
+    close(SyncPolicy::Flush);
+}
+
+bool FileSink::isOpen() const {
+#ifdef _WIN32
+    return handle != nullptr;
+#else
+    return fd >= 0;
+#endif
+}
+
+bool FileSink::open(const std::string& path, Mode mode) {
+    close(SyncPolicy::Flush);
+    filepath = path;
+    buffered = 0;
+    fileOffset = 0;
+    failed = false;
+
+    if (!buffer) {
+        buffer.reset(static_cast<char*>(::operator new[](bufferSize, std::align_val_t(BUFFER_ALIGNMENT))));
+    }
+
+#ifdef _WIN32
+    const DWORD disposition = mode == Mode::Truncate ? CREATE_ALWAYS
+                            : mode == Mode::Append ? OPEN_ALWAYS
+                            : OPEN_EXISTING;
+    // Shared so segments, the hash read-back and the sidecar writer can use the file concurrently
+    HANDLE h = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                           disposition, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    handle = h;
+
+    if (mode == Mode::Append) {
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(h, &size)) {
+            close(SyncPolicy::Flush);
+            return false;
+        }
+        fileOffset = static_cast<std::uint64_t>(size.QuadPart);
+    }
+#else
+    int flags = O_WRONLY | O_CLOEXEC;
+    if (mode == Mode::Truncate) flags |= O_CREAT | O_TRUNC;
+    if (mode == Mode::Append) flags |= O_CREAT;
+    fd = ::open(path.c_str(), flags, 0644);
+    if (fd < 0) return false;
+
+    if (mode == Mode::Append) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(SyncPolicy::Flush);
+            return false;
+        }
+        fileOffset = static_cast<std::uint64_t>(st.st_size);
+    }
+#endif
+    return true;
+}
+
+bool FileSink::writeAt(const char* data, size_t length, std::uint64_t offset) {
+#ifdef _WIN32
+    while (length > 0) {
+        OVERLAPPED position = {};
+        position.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFu);
+        position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        const DWORD chunk = static_cast<DWORD>(std::min<size_t>(length, 1u << 30));
+        DWORD written = 0;
+        if (!WriteFile(static_cast<HANDLE>(handle), data, chunk, &written, &position) || written == 0) {
+            return false;
+        }
+        data += written;
+        length -= written;
+        offset += written;
+    }
+#else
+    while (length > 0) {
+        const ssize_t written = pwrite(fd, data, length, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (written == 0) return false;
+        data += written;
+        length -= static_cast<size_t>(written);
+        offset += static_cast<std::uint64_t>(written);
+    }
+#endif
+    return true;
+}
+
+bool FileSink::preallocate(std::uint64_t totalSize) {
+    if (!isOpen() || totalSize == 0) return false;
+#ifdef _WIN32
+    // Reserves clusters but leaves end-of-file alone, unlike SetEndOfFile
+    FILE_ALLOCATION_INFO info = {};
+    info.AllocationSize.QuadPart = static_cast<LONGLONG>(totalSize);
+    return SetFileInformationByHandle(static_cast<HANDLE>(handle), FileAllocationInfo, &info, sizeof(info)) != FALSE;
+#elif defined(__linux__)
+    return fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(totalSize)) == 0;
+#else
+    return false;
+#endif
+}
+
+size_t FileSink::write(const void* data, size_t length) {
+    if (!isOpen() || failed) return 0;
+
+    const char* bytes = static_cast<const char*>(data);
+    size_t remaining = length;
+    while (remaining > 0) {
+        // Nothing to coalesce with: hand large chunks straight to the OS
+        if (buffered == 0 && remaining >= bufferSize) {
+            if (!writeAt(bytes, remaining, fileOffset)) {
+                failed = true;
+                return 0;
+            }
+            fileOffset += remaining;
+            return length;
+        }
+
+        const size_t take = std::min(remaining, bufferSize - buffered);
+        std::memcpy(buffer.get() + buffered, bytes, take);
+        buffered += take;
+        bytes += take;
+        remaining -= take;
+
+        if (buffered == bufferSize && !flush()) return 0;
+    }
+    return length;
+}
+
+bool FileSink::flush() {
+    if (failed) return false;
+    if (buffered == 0) return true;
+
+    if (!writeAt(buffer.get(), buffered, fileOffset)) {
+        failed = true;
+        return false;
+    }
+    fileOffset += buffered;
+    buffered = 0;
+    return true;
+}
+
+bool FileSink::seek(std::uint64_t offset) {
+    if (!flush()) return false;
+    fileOffset = offset;
+    return true;
+}
+
+bool FileSink::reset() {
+    if (!isOpen()) return false;
+    buffered = 0;
+    fileOffset = 0;
+    failed = false;
+#ifdef _WIN32
+    LARGE_INTEGER zero = {};
+    return SetFilePointerEx(static_cast<HANDLE>(handle), zero, nullptr, FILE_BEGIN) &&
+           SetEndOfFile(static_cast<HANDLE>(handle));
+#else
+    return ftruncate(fd, 0) == 0;
+#endif
+}
+
+bool FileSink::close(SyncPolicy policy) {
+    if (!isOpen()) return !failed;
+
+    bool ok = flush();
+#ifdef _WIN32
+    if (ok && policy == SyncPolicy::Fsync) {
+        ok = FlushFileBuffers(static_cast<HANDLE>(handle)) != FALSE;
+    }
+    ok = CloseHandle(static_cast<HANDLE>(handle)) != FALSE && ok;
+    handle = nullptr;
+#else
+    if (ok && policy == SyncPolicy::Fsync) {
+#ifdef __linux__
+        ok = fdatasync(fd) == 0;
+#else
+        ok = fsync(fd) == 0;
+#endif
+    }
+    ok = ::close(fd) == 0 && ok;
+    fd = -1;
+#endif
+    return ok;
+}
+
+bool syncFile(const std::string& path) {
+#ifdef _WIN32
+    HANDLE h = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    const bool ok = FlushFileBuffers(h) != FALSE;
+    CloseHandle(h);
+    return ok;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    const bool ok = fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
@@ -0,0 +1,306 @@
+#include "include/hash.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <wincrypt.h>
+#endif
+
+const char* hashAlgorithmName(HashAlgorithm algorithm) {
+    return algorithm == HashAlgorithm::SHA256 ? "SHA-256" : "SHA-1";
+}
+
+static std::string toHex(const unsigned char* bytes, size_t length) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(length * 2);
+    for (size_t i = 0; i < length; ++i) {
+        hex.push_back(digits[bytes[i] >> 4]);
+        hex.push_back(digits[bytes[i] & 0x0F]);
+    }
+    return hex;
+}
+
+#ifdef _WIN32
+
+// CryptoAPI context; PROV_RSA_AES is the provider that implements SHA-256
+struct StreamingHash::State {
+    HashAlgorithm algorithm;
+    HCRYPTPROV provider = 0;
+    HCRYPTHASH hash = 0;
+    bool failed = false;
+
+    explicit State(HashAlgorithm algo) : algorithm(algo) { open(); }
+
+    ~State() { close(); }
+
+    void open() {
+        failed = !CryptAcquireContext(&provider, nullptr, nullptr, PROV_RSA_AES, CRYPT_VERIFYCONTEXT);
+        if (failed) {
+            provider = 0;
+            return;
+        }
+        const ALG_ID alg = algorithm == HashAlgorithm::SHA256 ? CALG_SHA_256 : CALG_SHA1;
+        failed = !CryptCreateHash(provider, alg, 0, 0, &hash);
+        if (failed) hash = 0;
+    }
+
+    void close() {
+        if (hash) CryptDestroyHash(hash);
+        if (provider) CryptReleaseContext(provider, 0);
+        hash = 0;
+        provider = 0;
+    }
+
+    void update(const unsigned char* data, size_t length) {
+        // CryptHashData takes a DWORD length, so feed very large buffers in pieces
+        while (!failed && length > 0) {
+            const DWORD chunk = static_cast<DWORD>(std::min<size_t>(length, 1u << 30));
+            failed = !CryptHashData(hash, data, chunk, 0);
+            data += chunk;
+            length -= chunk;
+        }
+    }
+
+    std::string finish() {
+        BYTE digest[32];
+        DWORD digestLen = sizeof(digest);
+        const bool ok = !failed && CryptGetHashParam(hash, HP_HASHVAL, digest, &digestLen, 0);
+        close();
+        open();
+        return ok ? toHex(digest, digestLen) : "";
+    }
+};
+
+#else
+
+// Portable SHA-1 / SHA-256 for builds without CryptoAPI
+struct StreamingHash::State {
+    HashAlgorithm algorithm;
+    std::uint32_t h[8];
+    unsigned char block[64];
+    size_t blockLen = 0;
+    std::uint64_t totalLen = 0;
+
+    explicit State(HashAlgorithm algo) : algorithm(algo) { open(); }
+
+    void open() {
+        static const std::uint32_t sha1Init[5] = {
+            0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0
+        };
+        static const std::uint32_t sha256Init[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+        if (algorithm == HashAlgorithm::SHA256) {
+            std::memcpy(h, sha256Init, sizeof(sha256Init));
+        } else {
+            std::memcpy(h, sha1Init, sizeof(sha1Init));
+        }
+        blockLen = 0;
+        totalLen = 0;
+    }
+
+    static std::uint32_t rotl(std::uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+    static std::uint32_t rotr(std::uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+    static std::uint32_t loadBE(const unsigned char* p) {
+        return (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16) |
+               (static_cast<std::uint32_t>(p[2]) << 8) | static_cast<std::uint32_t>(p[3]);
+    }
+
+    void compressSha1(const unsigned char* p) {
+        std::uint32_t w[80];
+        for (int i = 0; i < 16; ++i) w[i] = loadBE(p + i * 4);
+        for (int i = 16; i < 80; ++i) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        std::uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            std::uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            const std::uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    void compressSha256(const unsigned char* p) {
+        static const std::uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+
+        std::uint32_t w[64];
+        for (int i = 0; i < 16; ++i) w[i] = loadBE(p + i * 4);
+        for (int i = 16; i < 64; ++i) {
+            const std::uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const std::uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        std::uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+        for (int i = 0; i < 64; ++i) {
+            const std::uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+            const std::uint32_t ch = (e & f) ^ (~e & g);
+            const std::uint32_t temp1 = hh + s1 + ch + k[i] + w[i];
+            const std::uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+            const std::uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            const std::uint32_t temp2 = s0 + maj;
+            hh = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + temp2;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+    }
+
+    void compress(const unsigned char* p) {
+        if (algorithm == HashAlgorithm::SHA256) {
+            compressSha256(p);
+        } else {
+            compressSha1(p);
+        }
+    }
+
+    void update(const unsigned char* data, size_t length) {
+        totalLen += length;
+
+        if (blockLen > 0) {
+            const size_t take = std::min(length, sizeof(block) - blockLen);
+            std::memcpy(block + blockLen, data, take);
+            blockLen += take;
+            data += take;
+            length -= take;
+            if (blockLen < sizeof(block)) return;
+            compress(block);
+            blockLen = 0;
+        }
+
+        // Hash whole blocks straight from the caller's buffer
+        for (; length >= sizeof(block); data += sizeof(block), length -= sizeof(block)) {
+            compress(data);
+        }
+
+        if (length > 0) {
+            std::memcpy(block, data, length);
+            blockLen = length;
+        }
+    }
+
+    std::string finish() {
+        const std::uint64_t bitLen = totalLen * 8;
+        const unsigned char pad = 0x80;
+        const unsigned char zero = 0;
+        update(&pad, 1);
+        while (blockLen != 56) update(&zero, 1);
+
+        unsigned char lenBytes[8];
+        for (int i = 0; i < 8; ++i) lenBytes[i] = static_cast<unsigned char>(bitLen >> (56 - i * 8));
+        update(lenBytes, sizeof(lenBytes));
+
+        const int words = algorithm == HashAlgorithm::SHA256 ? 8 : 5;
+        unsigned char digest[32];
+        for (int i = 0; i < words; ++i) {
+            digest[i * 4] = static_cast<unsigned char>(h[i] >> 24);
+            digest[i * 4 + 1] = static_cast<unsigned char>(h[i] >> 16);
+            digest[i * 4 + 2] = static_cast<unsigned char>(h[i] >> 8);
+            digest[i * 4 + 3] = static_cast<unsigned char>(h[i]);
+        }
+        open();
+        return toHex(digest, static_cast<size_t>(words) * 4);
+    }
+};
+
+#endif
+
+StreamingHash::StreamingHash(HashAlgorithm algorithm)
+    : state(std::make_unique<State>(algorithm)), algo(algorithm) {}
+
+StreamingHash::~StreamingHash() = default;
+
+StreamingHash::StreamingHash(StreamingHash&& other) noexcept = default;
+
+StreamingHash& StreamingHash::operator=(StreamingHash&& other) noexcept = default;
+
+void StreamingHash::update(const void* data, size_t length) {
+    if (state && length > 0) {
+        state->update(static_cast<const unsigned char*>(data), length);
+    }
+}
+
+std::string StreamingHash::finish() {
+    return state ? state->finish() : "";
+}
+
+void StreamingHash::reset() {
+    state = std::make_unique<State>(algo);
+}
+
+bool hashFileRange(StreamingHash& hash, const std::string& path, std::uint64_t offset, std::uint64_t length) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    if (offset > 0 && !file.seekg(static_cast<std::streamoff>(offset))) return false;
+
+    std::vector<char> buffer(256 * 1024);
+    while (length > 0) {
+        const auto want = static_cast<std::streamsize>(std::min<std::uint64_t>(length, buffer.size()));
+        file.read(buffer.data(), want);
+        const auto count = file.gcount();
+        if (count <= 0) return false;
+        hash.update(buffer.data(), static_cast<size_t>(count));
+        length -= static_cast<std::uint64_t>(count);
+    }
+    return true;
+}
+
+std::string computeFileHash(const std::string& path, HashAlgorithm algorithm) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return "";
+
+    StreamingHash hash(algorithm);
+    std::vector<char> buffer(256 * 1024);
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (const auto count = file.gcount(); count > 0) {
+            hash.update(buffer.data(), static_cast<size_t>(count));
+        }
+    }
+    if (file.bad()) return "";
+    return hash.finish();
+}
+
+bool digestEquals(const std::string& a, const std::string& b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](unsigned char x, unsigned char y) {
+               return std::tolower(x) == std::tolower(y);
+           });
+}
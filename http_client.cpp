@@ -0,0 +1,163 @@
+#include "include/http_client.h"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+HttpClient::HttpClient() : shareHandle(curl_share_init()) {
+    if (!shareHandle) {
+        std::cerr << "Failed to initialize CURL share handle; DNS and TLS sessions will not be shared" << std::endl;
+        return;
+    }
+
+    curl_share_setopt(shareHandle, CURLSHOPT_LOCKFUNC, lockShare);
+    curl_share_setopt(shareHandle, CURLSHOPT_UNLOCKFUNC, unlockShare);
+    curl_share_setopt(shareHandle, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    // Connection caches stay with each multi and pooled easy handle: curl does not support
+    // sharing one between threads, and the event loop runs next to the blocking paths
+}
+
+HttpClient::~HttpClient() {
+    shutdown();
+}
+
+HttpClient& HttpClient::getInstance() {
+    static HttpClient instance;
+    return instance;
+}
+
+void HttpClient::lockShare(CURL* /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void* userptr) {
+    static_cast<HttpClient*>(userptr)->shareLocks[data].lock();
+}
+
+void HttpClient::unlockShare(CURL* /*handle*/, curl_lock_data data, void* userptr) {
+    static_cast<HttpClient*>(userptr)->shareLocks[data].unlock();
+}
+
+void HttpClient::setHttp2(bool enabled) {
+    http2 = enabled;
+}
+
+CURL* HttpClient::acquire() {
+    CURL* handle = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (!idleHandles.empty()) {
+            handle = idleHandles.back();
+            idleHandles.pop_back();
+        }
+    }
+
+    if (handle) {
+        // Reset clears per-request options but keeps the handle's own caches warm
+        curl_easy_reset(handle);
+        ++handlesReused;
+    } else {
+        handle = curl_easy_init();
+        if (!handle) return nullptr;
+        ++handlesCreated;
+    }
+
+    if (shareHandle) {
+        curl_easy_setopt(handle, CURLOPT_SHARE, shareHandle);
+    }
+    if (http2) {
+        curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    } else {
+        curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    }
+    return handle;
+}
+
+void HttpClient::setUrl(CURL* handle, const std::string& url) const {
+    curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+    const bool tls = url.size() >= 8 && std::equal(url.begin(), url.begin() + 8, "https://", [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == b;
+    });
+    // Wait for a connection that may turn out to multiplex instead of opening another one
+    curl_easy_setopt(handle, CURLOPT_PIPEWAIT, http2 && tls ? 1L : 0L);
+}
+
+void HttpClient::release(CURL* handle) {
+    if (!handle) return;
+
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (shareHandle && idleHandles.size() < MAX_IDLE_HANDLES) {
+            idleHandles.push_back(handle);
+            return;
+        }
+    }
+    curl_easy_cleanup(handle);
+}
+
+static std::string hostOf(const char* url) {
+    std::string host;
+    CURLU* parsed = curl_url();
+    if (!parsed) return host;
+    char* part = nullptr;
+    if (curl_url_set(parsed, CURLUPART_URL, url, 0) == CURLUE_OK &&
+        curl_url_get(parsed, CURLUPART_HOST, &part, 0) == CURLUE_OK) {
+        host = part;
+        curl_free(part);
+    }
+    curl_url_cleanup(parsed);
+    return host;
+}
+
+void HttpClient::recordTransfer(CURL* handle) {
+    long connects = 0;
+    if (curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects) != CURLE_OK) return;
+
+    ++transfers;
+    if (connects > 0) {
+        newConnections += static_cast<std::uint64_t>(connects);
+    } else {
+        ++reusedConnections;
+    }
+
+    char* url = nullptr;
+    long version = CURL_HTTP_VERSION_NONE;
+    curl_easy_getinfo(handle, CURLINFO_EFFECTIVE_URL, &url);
+    curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &version);
+    if (!url) return;
+
+    const std::string host = hostOf(url);
+    std::lock_guard<std::mutex> lock(hostMutex);
+    HttpHostStats& stats = hostStats[host];
+    ++stats.requests;
+    if (version == CURL_HTTP_VERSION_2_0) ++stats.http2Streams;
+    stats.newConnections += static_cast<std::uint64_t>(std::max(connects, 0L));
+}
+
+HttpClientStats HttpClient::getStats() const {
+    HttpClientStats stats;
+    stats.transfers = transfers.load();
+    stats.newConnections = newConnections.load();
+    stats.reusedConnections = reusedConnections.load();
+    stats.handlesCreated = handlesCreated.load();
+    stats.handlesReused = handlesReused.load();
+    return stats;
+}
+
+std::map<std::string, HttpHostStats> HttpClient::getHostStats() const {
+    std::lock_guard<std::mutex> lock(hostMutex);
+    return hostStats;
+}
+
+void HttpClient::shutdown() {
+    std::vector<CURL*> handles;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        handles.swap(idleHandles);
+    }
+    for (CURL* handle : handles) {
+        curl_easy_cleanup(handle);
+    }
+
+    if (shareHandle) {
+        curl_share_cleanup(shareHandle);
+        shareHandle = nullptr;
+    }
+}
@@ -0,0 +1,171 @@
+#include "include/http_event_loop.h"
+#include "include/http_client.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+
+// Queued or running attempt of a transfer
+struct HttpEventLoop::Entry {
+    std::unique_ptr<AsyncTransfer> transfer;
+    std::chrono::steady_clock::time_point notBefore;
+    std::optional<PooledCurlHandle> curl;  // Held only while an attempt runs
+    TransferSlot slot;
+};
+
+HttpEventLoop& HttpEventLoop::getInstance() {
+    static HttpEventLoop instance;
+    return instance;
+}
+
+HttpEventLoop::~HttpEventLoop() {
+    shutdown();
+}
+
+void HttpEventLoop::submit(std::unique_ptr<AsyncTransfer> transfer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (quit) {
+        transfer->abandon();
+        return;
+    }
+    if (!running) {
+        multi = curl_multi_init();
+        if (!multi) {
+            std::cerr << "Failed to initialize CURL multi handle for async requests" << std::endl;
+            transfer->abandon();
+            return;
+        }
+        curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        running = true;
+        thread = std::thread(&HttpEventLoop::run, this);
+    }
+    incoming.push_back(std::move(transfer));
+    curl_multi_wakeup(multi);
+}
+
+void HttpEventLoop::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        if (!running) return;
+        curl_multi_wakeup(multi);
+    }
+    thread.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    curl_multi_cleanup(multi);
+    multi = nullptr;
+    running = false;
+}
+
+void HttpEventLoop::run() {
+    constexpr auto IDLE_WAIT = std::chrono::milliseconds(1000);
+    constexpr auto SLOT_RECHECK = std::chrono::milliseconds(50);  // Slots freed by other threads do not wake the loop
+
+    std::deque<std::unique_ptr<Entry>> waiting;
+    std::unordered_map<CURL*, std::unique_ptr<Entry>> active;
+
+    // Schedule the next attempt after its backoff, or settle the transfer as failed
+    auto failAttempt = [&](std::unique_ptr<Entry> entry, const AttemptFailure& failure) {
+        entry->curl.reset();
+        entry->slot.release();
+
+        std::chrono::milliseconds delay{0};
+        const RetryDecision decision = entry->transfer->retry.next(failure, delay);
+        if (decision != RetryDecision::Retry) {
+            std::cerr << "Giving up on " << entry->transfer->describe() << ": " << retryDecisionText(decision) << std::endl;
+            entry->transfer->abandon();
+            return;
+        }
+        std::cout << "\nRetry attempt " << entry->transfer->retry.attempt() << "/" << entry->transfer->retry.maxAttempts()
+                 << " of " << entry->transfer->describe() << " in " << std::fixed << std::setprecision(1)
+                 << (delay.count() / 1000.0) << " s..." << std::endl;
+        entry->notBefore = std::chrono::steady_clock::now() + delay;
+        waiting.push_back(std::move(entry));
+    };
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (quit) break;
+            const auto now = std::chrono::steady_clock::now();
+            for (auto& transfer : incoming) {
+                auto entry = std::make_unique<Entry>();
+                entry->transfer = std::move(transfer);
+                entry->notBefore = now;
+                waiting.push_back(std::move(entry));
+            }
+            incoming.clear();
+        }
+
+        // Start every attempt that is due and admitted; failures to start go back to waiting
+        const auto now = std::chrono::steady_clock::now();
+        std::deque<std::unique_ptr<Entry>> due;
+        for (auto it = waiting.begin(); it != waiting.end();) {
+            if ((*it)->notBefore > now) {
+                ++it;
+                continue;
+            }
+            TransferSlot slot = DownloadScheduler::getInstance().tryAcquire((*it)->transfer->transferClass);
+            if (!slot) {
+                ++it;
+                continue;
+            }
+            (*it)->slot = std::move(slot);
+            due.push_back(std::move(*it));
+            it = waiting.erase(it);
+        }
+        for (auto& entry : due) {
+            entry->curl.emplace();
+            CURL* handle = entry->curl->get();
+            if (!handle || !entry->transfer->begin(handle) || curl_multi_add_handle(multi, handle) != CURLM_OK) {
+                failAttempt(std::move(entry), AttemptFailure::local());
+                continue;
+            }
+            active.emplace(handle, std::move(entry));
+        }
+
+        int stillRunning = 0;
+        if (curl_multi_perform(multi, &stillRunning) != CURLM_OK) {
+            std::cerr << "CURL multi perform failed" << std::endl;
+        }
+
+        int queued = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            auto it = active.find(msg->easy_handle);
+            if (it == active.end()) continue;
+
+            std::unique_ptr<Entry> entry = std::move(it->second);
+            active.erase(it);
+            CURL* handle = msg->easy_handle;
+            const CURLcode result = msg->data.result;
+            curl_multi_remove_handle(multi, handle);
+            HttpClient::getInstance().recordTransfer(handle);
+
+            if (const auto failure = entry->transfer->end(handle, result)) {
+                failAttempt(std::move(entry), *failure);
+            }
+        }
+
+        // Sleep until the next backoff ends; entries still waiting for a slot are rechecked shortly
+        const auto polled = std::chrono::steady_clock::now();
+        auto wakeAt = polled + IDLE_WAIT;
+        for (const auto& entry : waiting) wakeAt = std::min(wakeAt, std::max(entry->notBefore, polled + SLOT_RECHECK));
+        const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(wakeAt - polled);
+        curl_multi_poll(multi, nullptr, 0, static_cast<int>(std::clamp<long long>(wait.count(), 0, IDLE_WAIT.count())), nullptr);
+    }
+
+    // Shutting down: nobody will see these finish
+    for (auto& [handle, entry] : active) {
+        curl_multi_remove_handle(multi, handle);
+        entry->transfer->abandon();
+    }
+    for (auto& entry : waiting) entry->transfer->abandon();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& transfer : incoming) transfer->abandon();
+    incoming.clear();
+}
@@ -1,8 +1,148 @@
 #ifndef ARCHIVE_H
 #define ARCHIVE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
+// Central directory record of one zip entry
+struct ZipEntryInfo {
+    std::string name;  // As stored in the archive; directories end in '/'
+    std::uint16_t method = 0;
+    std::uint32_t crc = 0;
+    std::uint64_t compressedSize = 0;
+    std::uint64_t uncompressedSize = 0;
+    bool isDirectory = false;
+};
+
+// Zip file memory-mapped and indexed from its central directory. Entries can be listed
+// without touching their data, and any subset extracted in parallel straight from the
+// mapping, one worker per core. Stored and deflated entries, zip64, and Unix executable
+// bits are supported; every extracted entry is CRC-checked.
+class ZipReader {
+public:
+    using EntryFilter = std::function<bool(const ZipEntryInfo&)>;
+
+private:
+    struct State;
+    std::unique_ptr<State> state;
+
+public:
+    ZipReader();
+    ~ZipReader();
+
+    ZipReader(const ZipReader&) = delete;
+    ZipReader& operator=(const ZipReader&) = delete;
+
+    // Map the file and read its central directory; rejects paths escaping the extraction root
+    bool open(const std::string& zipPath);
+    void close();
+
+    const std::vector<ZipEntryInfo>& entries() const;
+
+    // Extract the entries the filter accepts (every entry without one). maxThreads 0 uses all cores.
+    bool extract(const std::string& extractDir, const EntryFilter& filter = nullptr, size_t maxThreads = 0);
+
+    // Extract into a fresh stagingDir for a later swap. Files of baseDir whose size and CRC-32
+    // already match their entry are hard-linked (copied if links fail) instead of inflated.
+    bool stage(const std::string& stagingDir, const std::string& baseDir);
+
+    const std::string& error() const;
+
+    // Of the last extract() or stage()
+    size_t filesExtracted() const;       // Written
+    std::uint64_t bytesExtracted() const;
+    size_t filesSkipped() const;         // Linked from baseDir by stage()
+};
+
+// Extract a whole zip file with ZipReader
 bool extractArchive(const std::string& zipPath, const std::string& extractDir);
 
-#endif // ARCHIVE_H
\ No newline at end of file
+// Extracts a zip archive from a forward-only byte stream, writing each entry as soon
+// as its local header and data arrive, so extraction overlaps the download. The central
+// directory is never needed. Supports stored and deflated entries, data descriptors
+// and zip64 sizes; every entry is CRC-checked.
+class ZipStreamExtractor {
+private:
+    struct State;
+    std::unique_ptr<State> state;
+
+public:
+    explicit ZipStreamExtractor(const std::string& extractDir);
+    ~ZipStreamExtractor();
+
+    ZipStreamExtractor(const ZipStreamExtractor&) = delete;
+    ZipStreamExtractor& operator=(const ZipStreamExtractor&) = delete;
+
+    // Start over from byte zero, deleting everything extracted so far
+    bool reset();
+
+    // Consume the next chunk of the archive; false stops the stream
+    bool feed(const char* data, size_t length);
+
+    // True once the stream reached the central directory with every entry complete
+    bool finish();
+
+    // The archive needs a seekable reader (encrypted entries, unknown methods, or a
+    // stored entry with a data descriptor); extract it from a file instead
+    bool unsupported() const;
+
+    const std::string& error() const;
+
+    size_t entriesExtracted() const;
+    std::uint64_t bytesExtracted() const;
+};
+
+// Container of an archive, from its first bytes
+enum class ArchiveFormat { Zip, Gzip, Zstd, Unknown };
+
+ArchiveFormat detectArchiveFormat(const char* data, size_t length);
+
+// Extracts a tarball from a forward-only byte stream: gzip (including concatenated
+// members), zstd when built with it, or uncompressed, told apart by the first bytes.
+// Understands ustar, GNU long names and pax paths; keeps executable bits on POSIX.
+// Symlinks must stay inside the extraction root and are created last, as copies of
+// their target where the OS refuses them.
+class TarStreamExtractor {
+private:
+    struct State;
+    std::unique_ptr<State> state;
+
+public:
+    explicit TarStreamExtractor(const std::string& extractDir);
+    ~TarStreamExtractor();
+
+    TarStreamExtractor(const TarStreamExtractor&) = delete;
+    TarStreamExtractor& operator=(const TarStreamExtractor&) = delete;
+
+    // Start over from byte zero, deleting everything extracted so far
+    bool reset();
+
+    // Consume the next chunk of the archive; false stops the stream
+    bool feed(const char* data, size_t length);
+
+    // True once the stream ended after a complete last entry; creates the symlinks
+    bool finish();
+
+    const std::string& error() const;
+
+    size_t entriesExtracted() const;
+    std::uint64_t bytesExtracted() const;
+};
+
+// Extract a .tar, .tar.gz or .tar.zst file with TarStreamExtractor
+bool extractTarball(const std::string& path, const std::string& extractDir);
+
+// Move every file under sourceDir into the same place under destDir, merging directories, then
+// remove sourceDir. Files it replaces are moved to the same place under backupDir. On failure
+// every move is undone and false is returned.
+bool moveTreeInto(const std::string& sourceDir, const std::string& destDir, const std::string& backupDir);
+
+// Delete a directory tree on a background thread. Rename it out of the way first so the name
+// can be reused at once; removals still pending when the process exits are finished then.
+void removeTreeInBackground(const std::string& path);
+
+#endif // ARCHIVE_H
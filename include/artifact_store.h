@@ -0,0 +1,63 @@
+#ifndef ARTIFACT_STORE_H
+#define ARTIFACT_STORE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include "hash.h"
+
+// Snapshot of store activity for the current run
+struct ArtifactStoreStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t added = 0;
+    std::uint64_t bytesReused = 0;
+};
+
+// Content-addressed cache of verified downloads shared by every instance on the machine.
+// Objects live at <root>/<sha1|sha256>/<first two hex digits>/<digest> and are installed
+// into a game directory by reflink where supported, else hardlink, else copy. A .verified
+// sidecar records the size and mtime at which an object's digest was last checked.
+class ArtifactStore {
+private:
+    mutable std::mutex rootMutex;
+    std::string root;
+
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> added{0};
+    std::atomic<std::uint64_t> bytesReused{0};
+
+    ArtifactStore() = default;
+
+public:
+    static ArtifactStore& getInstance();
+
+    ArtifactStore(const ArtifactStore&) = delete;
+    ArtifactStore& operator=(const ArtifactStore&) = delete;
+
+    // Empty root disables the store
+    void setRoot(const std::string& directory);
+
+    bool isEnabled() const;
+
+    // Where the object for a digest lives (empty when disabled or the digest is malformed)
+    std::string objectPath(HashAlgorithm algorithm, const std::string& digest) const;
+
+    // Place the stored object at destPath; false if the store does not hold it. An object whose
+    // size differs from expectedSize (0 when unknown), or that changed since its digest was last
+    // checked and no longer matches it, is evicted and reported as a miss.
+    bool install(HashAlgorithm algorithm, const std::string& digest, const std::string& destPath,
+                 std::uint64_t expectedSize = 0);
+
+    // Record a copy of an already verified file under its digest; no-op if the object exists
+    void add(HashAlgorithm algorithm, const std::string& digest, const std::string& sourcePath);
+
+    ArtifactStoreStats getStats() const;
+};
+
+// Per-user default: %LOCALAPPDATA%\PurrLauncher\store, or $XDG_CACHE_HOME/purrlauncher/store
+std::string defaultArtifactStoreDir();
+
+#endif // ARTIFACT_STORE_H
@@ -0,0 +1,81 @@
+#ifndef BULK_WRITER_H
+#define BULK_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// How BulkFileWriter gets whole small files onto disk
+enum class BulkWriteBackend {
+    Auto,        // io_uring where the kernel supports it, else ThreadPool
+    Direct,      // open/write/close on the calling thread
+    ThreadPool,  // open/write/close on helper threads, so the caller keeps inflating
+    IoUring      // Linux: open, write and close linked in one ring, many files per syscall
+};
+
+// "auto" / "direct" / "thread-pool" / "io-uring"
+const char* bulkWriteBackendName(BulkWriteBackend backend);
+
+// Backend new writers use; Auto unless changed (benchmarks compare them)
+BulkWriteBackend bulkWriteBackend();
+void setBulkWriteBackend(BulkWriteBackend backend);
+
+// Built with io_uring support and the running kernel accepts it (5.15+ for direct descriptors)
+bool ioUringAvailable();
+
+// Process-wide totals of every writer, for benchmarks
+struct BulkWriteStats {
+    std::uint64_t files = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t syscalls = 0;  // open/write/close calls, or ring setup and io_uring_enter calls
+};
+
+BulkWriteStats bulkWriteStats();
+void resetBulkWriteStats();
+
+// Writes many small files, each handed over complete, with as few syscalls per file as the
+// backend allows. At most queueDepth files are in flight; write() blocks beyond that. Files
+// are written in no particular order, and parent directories must already exist. Used by
+// one thread at a time.
+class BulkFileWriter {
+public:
+    // Larger files gain nothing from batching and go through FileSink
+    static constexpr size_t SMALL_FILE_LIMIT = 128 * 1024;
+    static constexpr size_t DEFAULT_QUEUE_DEPTH = 32;
+
+private:
+    struct Backend;
+    struct DirectBackend;
+    struct ThreadPoolBackend;
+    struct IoUringBackend;
+    std::unique_ptr<Backend> backend;
+
+public:
+    // threads: ThreadPool helpers, 0 for up to four
+    explicit BulkFileWriter(size_t threads = 0, size_t queueDepth = DEFAULT_QUEUE_DEPTH,
+                            BulkWriteBackend requested = bulkWriteBackend());
+    ~BulkFileWriter();
+
+    BulkFileWriter(const BulkFileWriter&) = delete;
+    BulkFileWriter& operator=(const BulkFileWriter&) = delete;
+
+    // Backend actually in use after fallbacks
+    BulkWriteBackend kind() const;
+
+    // Create or truncate path with the given contents. data must stay valid until flush() returns.
+    // False once any earlier write has failed.
+    bool write(const std::string& path, const char* data, size_t length, std::uint32_t mode = 0644);
+
+    // Same, keeping the buffer until the file is written
+    bool write(const std::string& path, std::vector<char> data, std::uint32_t mode = 0644);
+
+    // Wait until every queued file is on disk; false if any of them failed
+    bool flush();
+
+    // First failure, with the path
+    const std::string& error() const;
+};
+
+#endif // BULK_WRITER_H
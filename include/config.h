@@ -3,6 +3,9 @@
 #define CONFIG_H
 
 #include <string>
+#include <vector>
+#include "download_scheduler.h"
+#include "mirror_registry.h"
 
 // Main configuration functions
 bool loadConfig(std::string& javaPath, std::string& username, std::string& uuid, bool& debug,
@@ -14,6 +17,19 @@ void saveConfig(const std::string& javaPath, const std::string& username, const
                 const std::string& pack_manifest_url, const std::string& pack_version,
                 const std::string& log_file, const std::string& api_url, const std::string& auth_token);
 
+// Download-related settings; keys missing from config.json keep these defaults
+struct DownloadSettings {
+    bool artifactStore = true;       // "artifact_store"
+    std::string artifactStoreDir;    // "artifact_store_dir", empty for the per-user default
+    SchedulerSettings scheduler;     // "download_rate_limit_kb", "download_max_concurrent", "download_class_limits"
+    bool streamPackExtract = true;   // "stream_pack_extract": unpack pack.zip while it downloads
+    bool keepPackArchive = true;     // "keep_pack_archive": keep pack.zip for conditional re-downloads
+    bool http2 = true;               // "http2": multiplex requests to a host over one HTTP/2 connection
+    std::vector<MirrorGroup> mirrors;  // "mirrors": alternate hosts per artifact origin
+};
+
+DownloadSettings loadDownloadSettings();
+
 // Configuration validation and utility functions
 bool isValidRamValue(const std::string& ramValue);
 bool validateConfig(const std::string& javaPath, const std::string& max_ram,
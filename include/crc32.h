@@ -0,0 +1,29 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 implementations; the fastest one the CPU supports is picked on first use
+enum class Crc32Kernel {
+    SliceBy8,  // Portable table lookup, 8 bytes per step
+    Pclmul,    // x86 carry-less multiply folding (PCLMULQDQ)
+    ArmCrc     // ARMv8 CRC32 instructions
+};
+
+// "slice-by-8" / "pclmul" / "armv8-crc"
+const char* crc32KernelName(Crc32Kernel kernel);
+
+bool crc32KernelSupported(Crc32Kernel kernel);
+
+// Kernel used by crc32Update
+Crc32Kernel crc32ActiveKernel();
+
+// CRC-32 of zip and gzip (reflected 0xEDB88320), continued from a previous result like
+// zlib's crc32(): start with 0 and feed the data in any number of pieces
+std::uint32_t crc32Update(std::uint32_t crc, const void* data, size_t length);
+
+// Same with a specific kernel, for benchmarks; falls back to slice-by-8 when unsupported
+std::uint32_t crc32Update(Crc32Kernel kernel, std::uint32_t crc, const void* data, size_t length);
+
+#endif // CRC32_H
@@ -2,15 +2,114 @@
 #define DOWNLOAD_H
 
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <future>
+#include <unordered_map>
+#include "hash.h"
+#include "download_scheduler.h"
+
+// Single artifact queued for a batch download
+struct DownloadJob {
+    std::string url;
+    std::string outputPath;
+    std::uint64_t expectedSize = 0; // 0 when unknown
+    std::string sha1;               // Expected hex digest, empty to skip verification
+    std::string sha256;             // Checked instead of sha1 when set
+};
+
+// Aggregate result of a batch download
+struct DownloadReport {
+    size_t succeeded = 0;
+    size_t skipped = 0;   // Already present on disk with matching size/hash
+    size_t fromStore = 0; // Installed from the shared artifact store without a transfer
+    size_t failed = 0;
+    std::uint64_t bytesDownloaded = 0;
+    double elapsedSeconds = 0.0;
+    std::vector<std::string> failedPaths;
+    std::unordered_map<std::string, std::string> digests; // outputPath -> hex digest of files fetched or hash-checked
+
+    bool ok() const { return failed == 0; }
+};
+
+// Outcome of a conditional download
+enum class FetchStatus {
+    Downloaded,
+    NotModified,  // Server returned 304, local copy kept
+    Failed
+};
+
+// Outcome of a verified download
+struct DownloadResult {
+    FetchStatus status = FetchStatus::Failed;
+    std::string digest;  // Hex digest computed while streaming; on NotModified the one recorded earlier, if any
+
+    bool ok() const { return status != FetchStatus::Failed; }
+};
 
 // Download file from URL to local path with retry support
 // Supports both regular and streaming downloads
-bool downloadFile(const std::string& url, const std::string& outputPath);
+bool downloadFile(const std::string& url, const std::string& outputPath,
+                  TransferClass transferClass = TransferClass::Bulk);
+
+// Like downloadFile, but sends the ETag/Last-Modified recorded for this URL
+// (http_cache.json) and skips the transfer if the local copy is still current
+FetchStatus downloadFileIfModified(const std::string& url, const std::string& outputPath,
+                                   TransferClass transferClass = TransferClass::Manifest);
+
+// Hash the body as it is written to disk. A digest that does not match expectedHash
+// (hex, case-insensitive, empty to skip) fails the attempt and the file is never moved into place.
+// Two cases read data back: a resumed download reads its existing prefix once to seed the
+// digest, and a segmented one reads the bytes that arrived ahead of the hashed prefix.
+DownloadResult downloadFileVerified(const std::string& url, const std::string& outputPath,
+                                    HashAlgorithm algorithm, const std::string& expectedHash = "",
+                                    bool conditional = false, TransferClass transferClass = TransferClass::Bulk);
+
+// Receives a response body in order while it downloads
+class DownloadConsumer {
+public:
+    virtual ~DownloadConsumer() = default;
+
+    // Called before every attempt; anything consumed by an earlier attempt must be dropped
+    virtual bool begin() = 0;
+
+    // Next chunk of the body; false aborts the download without retrying
+    virtual bool consume(const char* data, size_t length) = 0;
+
+    // The whole body arrived and its digest matched; false fails the download
+    virtual bool finish() = 0;
+};
+
+// Feed the body straight to consumer instead of a file. With a cachePath the bytes are also
+// written there (moved into place only on success), so the next call can be conditional; on a
+// 304 or an artifact store hit the cached file is replayed through consumer instead.
+// Not resumable: a failed attempt restarts the consumer from byte zero.
+DownloadResult downloadStreamed(const std::string& url, DownloadConsumer& consumer, HashAlgorithm algorithm,
+                                const std::string& expectedHash = "", const std::string& cachePath = "",
+                                TransferClass transferClass = TransferClass::Bulk);
+
+// Download many files concurrently over a single curl multi handle.
+// At most maxConcurrent transfers are in flight (further limited by the scheduler's class cap);
+// each job gets up to maxRetries attempts, backing off as RetryPolicy::download() describes.
+DownloadReport downloadBatch(const std::vector<DownloadJob>& jobs, int maxConcurrent = 8, int maxRetries = 3,
+                             TransferClass transferClass = TransferClass::Library);
 
 // Perform HTTP GET request
-std::string httpGet(const std::string& url);
+std::string httpGet(const std::string& url, TransferClass transferClass = TransferClass::Auth);
 
 // Perform HTTP POST request with JSON data
-std::string httpPost(const std::string& url, const std::string& jsonData);
+std::string httpPost(const std::string& url, const std::string& jsonData,
+                     TransferClass transferClass = TransferClass::Auth);
+
+// Non-blocking variants, all driven by one shared event-loop thread (HttpEventLoop) so
+// independent round trips overlap. Same options, retries and results as the blocking calls.
+std::future<std::string> httpGetAsync(const std::string& url, TransferClass transferClass = TransferClass::Auth);
+
+std::future<std::string> httpPostAsync(const std::string& url, const std::string& jsonData,
+                                       TransferClass transferClass = TransferClass::Auth);
+
+// One job fetched and verified the way downloadBatch would. NotModified when the file was
+// already in place. Not shaped by the download rate limit; meant for small bootstrap files.
+std::future<DownloadResult> downloadAsync(const DownloadJob& job, TransferClass transferClass = TransferClass::Library);
 
-#endif // DOWNLOAD_H
\ No newline at end of file
+#endif // DOWNLOAD_H
@@ -0,0 +1,116 @@
+#ifndef DOWNLOAD_SCHEDULER_H
+#define DOWNLOAD_SCHEDULER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Priority classes, highest first
+enum class TransferClass {
+    Auth,      // Auth/API calls: never throttled, admitted ahead of everything else
+    Manifest,  // Small metadata the next step is waiting on
+    Library,   // Libraries, natives and other bootstrap artifacts
+    Bulk       // Pack archives, JDK and other large background transfers
+};
+
+constexpr size_t TRANSFER_CLASS_COUNT = 4;
+
+const char* transferClassName(TransferClass transferClass);
+
+struct SchedulerSettings {
+    std::uint64_t rateLimitBytesPerSecond = 0;  // 0 = unlimited
+    size_t maxConcurrent = 16;                  // Across all classes
+    size_t classLimits[TRANSFER_CLASS_COUNT] = {4, 4, 8, 2};
+};
+
+class DownloadScheduler;
+
+// RAII admission ticket for one transfer of a class
+class TransferSlot {
+private:
+    DownloadScheduler* scheduler = nullptr;
+    TransferClass transferClass = TransferClass::Bulk;
+
+    friend class DownloadScheduler;
+    TransferSlot(DownloadScheduler* owner, TransferClass cls) : scheduler(owner), transferClass(cls) {}
+
+public:
+    TransferSlot() = default;
+    ~TransferSlot() { release(); }
+
+    TransferSlot(const TransferSlot&) = delete;
+    TransferSlot& operator=(const TransferSlot&) = delete;
+
+    TransferSlot(TransferSlot&& other) noexcept : scheduler(other.scheduler), transferClass(other.transferClass) {
+        other.scheduler = nullptr;
+    }
+
+    TransferSlot& operator=(TransferSlot&& other) noexcept {
+        if (this != &other) {
+            release();
+            scheduler = other.scheduler;
+            transferClass = other.transferClass;
+            other.scheduler = nullptr;
+        }
+        return *this;
+    }
+
+    explicit operator bool() const { return scheduler != nullptr; }
+
+    void release();
+};
+
+// Process-wide admission control and bandwidth shaping for every HTTP transfer.
+// Slots cap how many transfers of each class run at once, and a waiting higher class
+// with room under its own cap is always admitted first. A global token bucket, fed from write callbacks, limits
+// total bandwidth, and tokens go to the highest class that is waiting for them.
+class DownloadScheduler {
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    SchedulerSettings settings;
+
+    size_t active[TRANSFER_CLASS_COUNT] = {};
+    size_t slotWaiters[TRANSFER_CLASS_COUNT] = {};
+    size_t tokenWaiters[TRANSFER_CLASS_COUNT] = {};
+    size_t totalActive = 0;
+
+    double tokens = 0.0;
+    std::chrono::steady_clock::time_point lastRefill = std::chrono::steady_clock::now();
+
+    DownloadScheduler() = default;
+
+    bool canAdmit(TransferClass transferClass) const;
+    bool higherSlotWaiting(TransferClass transferClass) const;
+    bool higherTokenWaiting(TransferClass transferClass) const;
+    void refill();
+
+    friend class TransferSlot;
+    void release(TransferClass transferClass);
+
+public:
+    static DownloadScheduler& getInstance();
+
+    DownloadScheduler(const DownloadScheduler&) = delete;
+    DownloadScheduler& operator=(const DownloadScheduler&) = delete;
+
+    void configure(const SchedulerSettings& newSettings);
+
+    // Block until a slot of this class is free
+    TransferSlot acquire(TransferClass transferClass);
+
+    // Non-blocking variant for event loops; an empty slot means "try again later"
+    TransferSlot tryAcquire(TransferClass transferClass);
+
+    // Account received bytes against the rate limit, sleeping as needed. Only for transfers
+    // that have their thread to themselves.
+    void throttle(TransferClass transferClass, size_t bytes);
+
+    // Non-blocking variant for transfers sharing a multi handle: account the bytes and return
+    // how long this transfer should stop receiving before its next chunk (zero if it need not)
+    std::chrono::milliseconds charge(TransferClass transferClass, size_t bytes);
+};
+
+#endif // DOWNLOAD_SCHEDULER_H
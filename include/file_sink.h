@@ -0,0 +1,83 @@
+#ifndef FILE_SINK_H
+#define FILE_SINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// What close() guarantees before returning
+enum class SyncPolicy {
+    Flush,  // Buffered bytes handed to the OS; survives a crash of the launcher
+    Fsync   // Also forced to stable storage; survives power loss, use before an atomic rename
+};
+
+// Buffered writer for downloads on a native file handle. Data is collected in a
+// page-aligned buffer and written in large positional writes, and the final size can
+// be reserved up front so big files are laid out contiguously.
+class FileSink {
+public:
+    enum class Mode {
+        Truncate,  // Create or empty the file
+        Append,    // Create if needed, continue at the current end
+        Update     // Existing file, position chosen with seek()
+    };
+
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;
+
+private:
+    struct AlignedDelete {
+        void operator()(char* p) const;
+    };
+
+#ifdef _WIN32
+    void* handle = nullptr;
+#else
+    int fd = -1;
+#endif
+    std::string filepath;
+    std::unique_ptr<char[], AlignedDelete> buffer;
+    size_t bufferSize;
+    size_t buffered = 0;
+    std::uint64_t fileOffset = 0;  // Where the buffer's first byte belongs
+    bool failed = false;
+
+    bool writeAt(const char* data, size_t length, std::uint64_t offset);
+
+public:
+    explicit FileSink(size_t bufferSize = DEFAULT_BUFFER_SIZE);
+    ~FileSink();
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    bool open(const std::string& path, Mode mode);
+
+    bool isOpen() const;
+
+    // Reserve disk blocks without changing the visible file size, so size checks and
+    // resume offsets still reflect what was actually written. Best effort.
+    bool preallocate(std::uint64_t totalSize);
+
+    // Returns bytes accepted: length on success, 0 after a write error
+    size_t write(const void* data, size_t length);
+
+    bool seek(std::uint64_t offset);
+
+    // Discard everything and continue from byte zero
+    bool reset();
+
+    // Hand buffered bytes to the OS
+    bool flush();
+
+    bool close(SyncPolicy policy = SyncPolicy::Flush);
+
+    std::uint64_t position() const { return fileOffset + buffered; }
+
+    const std::string& getPath() const { return filepath; }
+};
+
+// Force an already written file to stable storage
+bool syncFile(const std::string& path);
+
+#endif // FILE_SINK_H
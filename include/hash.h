@@ -0,0 +1,53 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+enum class HashAlgorithm {
+    SHA1,
+    SHA256
+};
+
+// "SHA-1" / "SHA-256", for log messages
+const char* hashAlgorithmName(HashAlgorithm algorithm);
+
+// Incremental digest fed as data arrives, so downloads are verified without re-reading the file
+class StreamingHash {
+private:
+    struct State;
+    std::unique_ptr<State> state;
+    HashAlgorithm algo;
+
+public:
+    explicit StreamingHash(HashAlgorithm algorithm = HashAlgorithm::SHA1);
+    ~StreamingHash();
+
+    StreamingHash(StreamingHash&& other) noexcept;
+    StreamingHash& operator=(StreamingHash&& other) noexcept;
+    StreamingHash(const StreamingHash&) = delete;
+    StreamingHash& operator=(const StreamingHash&) = delete;
+
+    void update(const void* data, size_t length);
+
+    // Lowercase hex digest of everything fed so far (empty on failure); the hash is reset afterwards
+    std::string finish();
+
+    // Start over, e.g. when a resumed download restarts from byte zero
+    void reset();
+
+    HashAlgorithm algorithm() const { return algo; }
+};
+
+// Feed bytes [offset, offset + length) of a file into hash; false if the file is shorter or unreadable
+bool hashFileRange(StreamingHash& hash, const std::string& path, std::uint64_t offset, std::uint64_t length);
+
+// Lowercase hex digest of a whole file, empty on failure
+std::string computeFileHash(const std::string& path, HashAlgorithm algorithm);
+
+// Case-insensitive comparison of hex digests
+bool digestEquals(const std::string& a, const std::string& b);
+
+#endif // HASH_H
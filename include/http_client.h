@@ -0,0 +1,124 @@
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <curl/curl.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Snapshot of connection reuse counters
+struct HttpClientStats {
+    std::uint64_t transfers = 0;
+    std::uint64_t newConnections = 0;
+    std::uint64_t reusedConnections = 0;
+    std::uint64_t handlesCreated = 0;
+    std::uint64_t handlesReused = 0;
+};
+
+// Requests per host, to check that HTTP/2 multiplexing is doing its job
+struct HttpHostStats {
+    std::uint64_t requests = 0;
+    std::uint64_t http2Streams = 0;   // Requests that went out as HTTP/2 streams
+    std::uint64_t newConnections = 0;
+};
+
+// Process-wide HTTP client: pools easy handles, which keep their connections between
+// requests, and shares DNS and TLS session caches between every request through one CURLSH
+class HttpClient {
+private:
+    static constexpr size_t MAX_IDLE_HANDLES = 16;
+
+    CURLSH* shareHandle;
+    std::mutex shareLocks[CURL_LOCK_DATA_LAST];
+    std::mutex poolMutex;
+    std::vector<CURL*> idleHandles;
+
+    std::atomic<std::uint64_t> transfers{0};
+    std::atomic<std::uint64_t> newConnections{0};
+    std::atomic<std::uint64_t> reusedConnections{0};
+    std::atomic<std::uint64_t> handlesCreated{0};
+    std::atomic<std::uint64_t> handlesReused{0};
+    std::atomic<bool> http2{true};
+
+    mutable std::mutex hostMutex;
+    std::map<std::string, HttpHostStats> hostStats;
+
+    HttpClient();
+
+    static void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void unlockShare(CURL* handle, curl_lock_data data, void* userptr);
+
+public:
+    static HttpClient& getInstance();
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    ~HttpClient();
+
+    // Negotiate HTTP/2 over TLS (ALPN) so requests to one host share a connection as
+    // multiplexed streams; servers without it, and plain http, keep using HTTP/1.1
+    void setHttp2(bool enabled);
+
+    // Take a reset handle attached to the shared caches (nullptr on failure)
+    CURL* acquire();
+
+    // Point a handle at url for a transfer that runs next to others on a multi handle. Waiting
+    // for a connection that may multiplex only pays off over TLS, where HTTP/2 can be negotiated;
+    // plain http requests would just queue behind each other. Handles that set CURLOPT_URL
+    // themselves never wait.
+    void setUrl(CURL* handle, const std::string& url) const;
+
+    // Return a handle to the pool once its transfer is finished
+    void release(CURL* handle);
+
+    // Account a completed transfer as a new or reused connection
+    void recordTransfer(CURL* handle);
+
+    HttpClientStats getStats() const;
+
+    std::map<std::string, HttpHostStats> getHostStats() const;
+
+    // Free pooled handles and the share; must run before curl_global_cleanup
+    void shutdown();
+};
+
+// RAII wrapper for pooled CURL handles
+class PooledCurlHandle {
+private:
+    CURL* curl;
+
+public:
+    PooledCurlHandle() : curl(HttpClient::getInstance().acquire()) {}
+
+    ~PooledCurlHandle() {
+        if (curl) {
+            HttpClient::getInstance().release(curl);
+        }
+    }
+
+    CURL* get() const { return curl; }
+
+    bool isValid() const { return curl != nullptr; }
+
+    PooledCurlHandle(const PooledCurlHandle&) = delete;
+    PooledCurlHandle& operator=(const PooledCurlHandle&) = delete;
+
+    PooledCurlHandle(PooledCurlHandle&& other) noexcept : curl(other.curl) {
+        other.curl = nullptr;
+    }
+
+    PooledCurlHandle& operator=(PooledCurlHandle&& other) noexcept {
+        if (this != &other) {
+            if (curl) HttpClient::getInstance().release(curl);
+            curl = other.curl;
+            other.curl = nullptr;
+        }
+        return *this;
+    }
+};
+
+#endif // HTTP_CLIENT_H
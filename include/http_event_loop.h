@@ -0,0 +1,71 @@
+#ifndef HTTP_EVENT_LOOP_H
+#define HTTP_EVENT_LOOP_H
+
+#include <curl/curl.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "download_scheduler.h"
+#include "retry_policy.h"
+
+// One request run by HttpEventLoop, over as many attempts as its RetryState allows.
+// All callbacks run on the loop thread.
+class AsyncTransfer {
+public:
+    AsyncTransfer(TransferClass cls, const RetryPolicy& policy) : transferClass(cls), retry(policy) {}
+    virtual ~AsyncTransfer() = default;
+
+    const TransferClass transferClass;
+    RetryState retry;
+
+    // Name used in retry messages
+    virtual std::string describe() const = 0;
+
+    // Set up curl for the next attempt (URL, callbacks, options); false counts as a failed attempt
+    virtual bool begin(CURL* curl) = 0;
+
+    // The attempt is over. Returning a failure retries it as the policy allows; nullopt means the
+    // transfer succeeded and has delivered its result.
+    virtual std::optional<AttemptFailure> end(CURL* curl, CURLcode result) = 0;
+
+    // No attempts left, or the loop is shutting down: deliver a failed result
+    virtual void abandon() = 0;
+};
+
+// Single background thread driving every async request over one curl multi handle, so
+// independent round trips (auth, manifests, small downloads) overlap instead of queueing
+// behind each other. Admission goes through DownloadScheduler like every other transfer;
+// backoff between attempts is a timer on the loop, never a sleep.
+class HttpEventLoop {
+private:
+    struct Entry;
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<AsyncTransfer>> incoming;
+    CURLM* multi = nullptr;  // Created and destroyed by the loop thread
+    std::thread thread;
+    bool running = false;
+    bool quit = false;
+
+    HttpEventLoop() = default;
+    ~HttpEventLoop();
+
+    void run();
+
+public:
+    static HttpEventLoop& getInstance();
+
+    HttpEventLoop(const HttpEventLoop&) = delete;
+    HttpEventLoop& operator=(const HttpEventLoop&) = delete;
+
+    // Hand a transfer to the loop, starting the thread on first use
+    void submit(std::unique_ptr<AsyncTransfer> transfer);
+
+    // Abandon everything still queued or running and stop the thread; call before HttpClient::shutdown
+    void shutdown();
+};
+
+#endif // HTTP_EVENT_LOOP_H
@@ -5,6 +5,7 @@
 #include <vector>
 #include <unordered_map>
 #include <nlohmann/json.hpp>
+#include "download.h"
 
 using json = nlohmann::json;
 
@@ -18,12 +19,25 @@ bool updatePack(const std::string& pack_url, const std::string& pack_manifest_ur
                std::string& pack_version, const std::string& gameDir,
                bool debug, const std::string& log_file);
 
+// Natives jar queued for download, with the library's "extract": {"exclude": [...]} prefixes
+struct NativeDownload {
+    DownloadJob job;
+    std::vector<std::string> exclude;
+};
+
 // Library processing functions
+// Missing artifacts are queued into the download vectors instead of being fetched inline;
+// ones with no download are left off the classpath and listed in missingLibraries
 bool processLibrary(const json& lib, const std::string& libDir,
-                   std::vector<std::string>& classpathEntries, const std::string& gameDir);
+                   std::vector<std::string>& classpathEntries, const std::string& gameDir,
+                   std::vector<DownloadJob>& libraryDownloads, std::vector<NativeDownload>& nativeDownloads,
+                   std::vector<std::string>& missingLibraries);
 bool isLibraryCompatible(const json& lib);
 std::string getLibraryPath(const json& lib);
-void processNatives(const json& lib, const std::string& gameDir);
+void processNatives(const json& lib, const std::string& gameDir, std::vector<NativeDownload>& nativeDownloads);
+bool fetchQueuedLibraries(const std::vector<DownloadJob>& libraryDownloads,
+                          const std::vector<NativeDownload>& nativeDownloads,
+                          std::vector<std::string>& classpathEntries, const std::string& gameDir);
 
 // JSON and argument processing
 bool loadVersionJson(const std::string& jsonPath, json& j, bool debug, const std::string& log_file);
@@ -69,9 +83,11 @@ void executeLaunchCommand(const std::string& javaPath, const std::string& javawP
                          const std::string& gameDir, bool debug);
 
 // Pack update helpers
-bool cleanupDirectoriesForUpdate(const std::string& gameDir, bool debug, const std::string& log_file);
+// Moves servers.dat and the pack folders into trashDir (renames only); rolls back on failure
+bool cleanupDirectoriesForUpdate(const std::string& gameDir, const std::string& trashDir,
+                                 bool debug, const std::string& log_file);
 bool downloadAndExtractPack(const std::string& pack_url, const std::string& gameDir,
-                           bool debug, const std::string& log_file);
+                           bool debug, const std::string& log_file, const std::string& expected_sha256 = "");
 
 // Utility functions
 std::string replaceAll(std::string str, const std::string& from, const std::string& to);
@@ -0,0 +1,88 @@
+#ifndef MIRROR_REGISTRY_H
+#define MIRROR_REGISTRY_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Alternate hosts for one class of artifacts: a URL that starts with origin can also be
+// fetched from each mirror by swapping that prefix
+struct MirrorGroup {
+    std::string name;                  // "java", "authlib", "pack", ...
+    std::string origin;
+    std::vector<std::string> mirrors;
+};
+
+// One place a URL can be fetched from
+struct MirrorCandidate {
+    std::string base;  // Prefix that identifies the mirror in the ranking
+    std::string url;
+    std::chrono::milliseconds hedgeAfter{0};  // p95 time to first byte: race the next candidate after this
+};
+
+// What one request to a mirror showed
+struct MirrorSample {
+    bool ok = false;
+    double ttfbMs = 0.0;
+    std::uint64_t bytes = 0;
+    double seconds = 0.0;  // Whole transfer, for throughput
+};
+
+// Ranks mirrors by measured time to first byte and throughput, and demotes the ones that
+// fail or keep losing hedged races. The ranking is persisted so the next run starts from it.
+class MirrorRegistry {
+private:
+    static constexpr size_t TTFB_WINDOW = 32;
+
+    struct Mirror {
+        double ttfbMs = 0.0;      // Smoothed; 0 until measured
+        double bytesPerSecond = 0.0;
+        std::deque<double> ttfbSamples;
+        int failures = 0;         // Consecutive
+        std::int64_t demotedUntil = 0;  // Unix seconds
+        std::int64_t probedAt = 0;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<MirrorGroup> groups;
+    std::map<std::string, Mirror> mirrors;  // By base
+    std::string statePath;
+    bool dirty = false;
+
+    MirrorRegistry() = default;
+
+    void load();
+    double score(const std::string& base, size_t configIndex, std::int64_t now) const;
+    void addTtfb(Mirror& mirror, double ttfbMs);
+
+public:
+    static MirrorRegistry& getInstance();
+
+    MirrorRegistry(const MirrorRegistry&) = delete;
+    MirrorRegistry& operator=(const MirrorRegistry&) = delete;
+
+    // Replace the mirror groups and load the ranking saved at path
+    void configure(const std::vector<MirrorGroup>& mirrorGroups, const std::string& path);
+
+    // Every place url can be fetched from, best first; just url itself when no group covers it
+    std::vector<MirrorCandidate> candidates(const std::string& url) const;
+
+    void record(const std::string& base, const MirrorSample& sample);
+
+    // A request gave up on this mirror after waiting this long for its first byte
+    void recordSlow(const std::string& base, double waitedMs);
+
+    // Measure time to first byte of every mirror not probed recently, all at once, and save
+    void probe(std::chrono::milliseconds timeout);
+
+    // "base: 120 ms, 8.5 MB/s" per mirror, best first within each group
+    std::vector<std::string> describe() const;
+
+    void save();
+};
+
+#endif // MIRROR_REGISTRY_H
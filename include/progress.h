@@ -0,0 +1,148 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class ProgressTracker;
+
+// One transfer's share of the aggregate progress. Used only by the thread running the
+// transfer; add() is a single relaxed atomic add, cheap enough for every write callback.
+class TransferProgress {
+private:
+    ProgressTracker* tracker = nullptr;
+    std::uint64_t received = 0;
+    std::uint64_t expected = 0;  // 0 while unknown
+
+    friend class ProgressTracker;
+    explicit TransferProgress(ProgressTracker* owner) : tracker(owner) {}
+
+public:
+    TransferProgress() = default;
+    ~TransferProgress() { finish(); }
+
+    TransferProgress(const TransferProgress&) = delete;
+    TransferProgress& operator=(const TransferProgress&) = delete;
+
+    TransferProgress(TransferProgress&& other) noexcept
+        : tracker(other.tracker), received(other.received), expected(other.expected) {
+        other.tracker = nullptr;
+    }
+
+    TransferProgress& operator=(TransferProgress&& other) noexcept {
+        if (this != &other) {
+            finish();
+            tracker = other.tracker;
+            received = other.received;
+            expected = other.expected;
+            other.tracker = nullptr;
+        }
+        return *this;
+    }
+
+    explicit operator bool() const { return tracker != nullptr; }
+
+    // Bytes this transfer will receive, once the response says so
+    void setExpected(std::uint64_t bytes);
+
+    void add(std::uint64_t bytes);
+
+    // The transfer is over; it counts as complete from now on
+    void finish();
+};
+
+// Bytes of queued transfers that have not started yet, so the bar shows the whole
+// job from the beginning. Transfers take their share as they start; whatever is
+// left (jobs that never ran) is dropped when the reservation goes away.
+class ProgressReservation {
+private:
+    ProgressTracker* tracker = nullptr;
+    std::uint64_t remaining = 0;
+
+    friend class ProgressTracker;
+    ProgressReservation(ProgressTracker* owner, std::uint64_t bytes) : tracker(owner), remaining(bytes) {}
+
+public:
+    ProgressReservation() = default;
+    ~ProgressReservation() { release(); }
+
+    ProgressReservation(const ProgressReservation&) = delete;
+    ProgressReservation& operator=(const ProgressReservation&) = delete;
+
+    // Hand bytes over to a transfer that is about to report them itself
+    void take(std::uint64_t bytes);
+
+    void release();
+};
+
+// Aggregates every running transfer into one console progress bar (total bytes, rate,
+// ETA, active transfers). A render thread draws it at a fixed frame rate, so curl
+// callbacks never format output or do rate math themselves.
+class ProgressTracker {
+private:
+    static constexpr auto FRAME_INTERVAL = std::chrono::milliseconds(250);
+
+    // Hot counters, updated lock-free from transfer threads
+    std::atomic<std::uint64_t> bytesReceived{0};
+    std::atomic<std::uint64_t> bytesExpected{0};
+    std::atomic<std::uint32_t> unknownSizes{0};
+
+    // Transfer bookkeeping, touched once per transfer
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread renderer;
+    bool quit = false;
+    size_t active = 0;    // Transfers plus reservations; the session ends when it drops to zero
+    size_t reserved = 0;  // Reservations among them, not shown as active transfers
+    std::string label;  // Name of the most recently started transfer
+
+    // Render state, owned by whoever holds drawMutex
+    std::mutex drawMutex;
+    bool sessionOpen = false;
+    size_t framesDrawn = 0;
+    size_t lastLineLength = 0;
+    size_t spinnerIndex = 0;
+    double rate = 0.0;  // Smoothed bytes per second
+    std::uint64_t lastSampleBytes = 0;
+    std::chrono::steady_clock::time_point sessionStart;
+    std::chrono::steady_clock::time_point lastSample;
+
+    ProgressTracker() = default;
+    ~ProgressTracker();
+
+    void renderLoop();
+    void draw(bool final, size_t activeTransfers, const std::string& currentLabel);
+
+    friend class TransferProgress;
+    friend class ProgressReservation;
+    void open();
+    void close(bool reservation);
+    void end(std::uint64_t received, std::uint64_t expected);
+
+public:
+    static ProgressTracker& getInstance();
+
+    ProgressTracker(const ProgressTracker&) = delete;
+    ProgressTracker& operator=(const ProgressTracker&) = delete;
+
+    TransferProgress begin(const std::string& name);
+
+    ProgressReservation reserve(std::uint64_t bytes);
+
+    // Stop the render thread; call before exit
+    void shutdown();
+};
+
+inline void TransferProgress::add(std::uint64_t bytes) {
+    if (!tracker) return;
+    received += bytes;
+    tracker->bytesReceived.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+#endif // PROGRESS_H
@@ -0,0 +1,65 @@
+#ifndef RETRY_POLICY_H
+#define RETRY_POLICY_H
+
+#include <curl/curl.h>
+#include <chrono>
+
+// Why an attempt failed, as far as retrying is concerned
+struct AttemptFailure {
+    CURLcode curlCode = CURLE_OK;
+    long httpStatus = 0;                        // 0 when no response arrived
+    std::chrono::milliseconds retryAfter{-1};   // Delay requested by the server, negative when absent
+
+    // Failure on our side (disk, digest mismatch, stale resume offset): worth another attempt
+    static AttemptFailure local() { return {}; }
+
+    // Result, status and Retry-After of a finished transfer
+    static AttemptFailure fromTransfer(CURL* curl, CURLcode result);
+
+    // Retrying cannot help: client errors other than 408/425/429, bad URLs, TLS verification, ...
+    bool permanent() const;
+};
+
+// Backoff schedule and limits for one operation
+struct RetryPolicy {
+    int maxAttempts = 3;
+    std::chrono::milliseconds baseDelay{1000};   // Upper bound of the first backoff
+    std::chrono::milliseconds maxDelay{30000};   // Cap of the exponential growth
+    std::chrono::milliseconds deadline{600000};  // No attempt starts later than this after the first
+
+    static RetryPolicy download();  // File transfers
+    static RetryPolicy api();       // Small auth/API requests
+};
+
+enum class RetryDecision {
+    Retry,
+    Permanent,      // The failure will not go away by asking again
+    OutOfAttempts,
+    PastDeadline    // The next attempt could not start before the deadline
+};
+
+const char* retryDecisionText(RetryDecision decision);
+
+// Attempt bookkeeping of one operation. Backoff is exponential with full jitter, so
+// clients that failed together do not come back together; a Retry-After on 429/503
+// replaces the backoff, with a little jitter of its own for the same reason.
+class RetryState {
+private:
+    RetryPolicy policy;
+    int attemptNumber = 1;
+    std::chrono::steady_clock::time_point started;
+
+public:
+    explicit RetryState(const RetryPolicy& retryPolicy);
+
+    int attempt() const { return attemptNumber; }
+    int maxAttempts() const { return policy.maxAttempts; }
+
+    // Time left before the deadline, zero once it passed
+    std::chrono::milliseconds remaining() const;
+
+    // Record a failed attempt. On Retry, delay is how long to wait before the next one.
+    RetryDecision next(const AttemptFailure& failure, std::chrono::milliseconds& delay);
+};
+
+#endif // RETRY_POLICY_H
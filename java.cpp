@@ -6,12 +6,29 @@
 
 namespace fs = std::filesystem;
 
+#ifndef _WIN32
+// Unpacks the JDK tarball while it downloads
+class JavaStreamConsumer : public DownloadConsumer {
+private:
+    TarStreamExtractor& extractor;
+
+public:
+    explicit JavaStreamConsumer(TarStreamExtractor& tar) : extractor(tar) {}
+
+    bool begin() override { return extractor.reset(); }
+    bool consume(const char* data, size_t length) override { return extractor.feed(data, length); }
+    bool finish() override { return extractor.finish(); }
+};
+#endif
+
 bool downloadAndExtractJava(std::string& javaPath) {
-    const std::string javaUrl = "https://github.com/adoptium/temurin17-binaries/releases/download/jdk-17.0.16%2B8/OpenJDK17U-jdk_x64_windows_hotspot_17.0.16_8.zip";
-    const std::string zipPath = "jdk.zip";
     const std::string extractDir = "java17";
     const std::string innerDir = "jdk-17.0.16+8";
 
+#ifdef _WIN32
+    const std::string javaUrl = "https://github.com/adoptium/temurin17-binaries/releases/download/jdk-17.0.16%2B8/OpenJDK17U-jdk_x64_windows_hotspot_17.0.16_8.zip";
+    const std::string zipPath = "jdk.zip";
+
     std::cout << "Downloading Java 17 ZIP archive from " << javaUrl << "..." << std::endl;
     if (!downloadFile(javaUrl, zipPath)) return false;
 
@@ -25,4 +42,21 @@ bool downloadAndExtractJava(std::string& javaPath) {
 
     fs::remove(zipPath);
     return true;
-}
\ No newline at end of file
+#else
+    // The tarball keeps the executable bits and the symlinks the JDK relies on
+    const std::string javaUrl = "https://github.com/adoptium/temurin17-binaries/releases/download/jdk-17.0.16%2B8/OpenJDK17U-jdk_x64_linux_hotspot_17.0.16_8.tar.gz";
+
+    std::cout << "Streaming Java 17 from " << javaUrl << " into extraction..." << std::endl;
+    TarStreamExtractor extractor(extractDir);
+    JavaStreamConsumer consumer(extractor);
+    if (!downloadStreamed(javaUrl, consumer, HashAlgorithm::SHA256).ok()) {
+        if (!extractor.error().empty()) std::cerr << "Extraction failed: " << extractor.error() << std::endl;
+        return false;
+    }
+    std::cout << "Extracted " << extractor.entriesExtracted() << " entries ("
+              << (extractor.bytesExtracted() / (1024 * 1024)) << " MB)." << std::endl;
+
+    javaPath = extractDir + "/" + innerDir + "/bin/java";
+    return fs::exists(javaPath);
+#endif
+}
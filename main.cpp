@@ -3,7 +3,12 @@
 #include "include/minecraft.h"
 #include "include/crypto.h"
 #include "include/logging.h"
-#include "include/download.h"  // For httpGet and httpPost
+#include "include/download.h"  // For httpGetAsync, httpPost and downloadAsync
+#include "include/http_client.h"
+#include "include/artifact_store.h"
+#include "include/progress.h"
+#include "include/mirror_registry.h"
+#include "include/http_event_loop.h"
 
 #include <iostream>
 #include <filesystem>
@@ -15,6 +20,7 @@
 #include <iomanip>  // For std::setw, std::setfill
 #include <memory>   // For smart pointers
 #include <vector>
+#include <future>
 #include <string>
 #include <io.h>     // For _open_osfhandle
 #include <fcntl.h>  // For _O_TEXT
@@ -36,7 +42,13 @@ extern void DownloadMissingPlugins(bool debug, const std::string& log_file);
 class CurlManager {
 public:
     CurlManager() { curl_global_init(CURL_GLOBAL_ALL); }
-    ~CurlManager() { curl_global_cleanup(); }
+    ~CurlManager() {
+        MirrorRegistry::getInstance().save();
+        HttpEventLoop::getInstance().shutdown();
+        ProgressTracker::getInstance().shutdown();
+        HttpClient::getInstance().shutdown();
+        curl_global_cleanup();
+    }
     CurlManager(const CurlManager&) = delete;
     CurlManager& operator=(const CurlManager&) = delete;
 };
@@ -158,7 +170,23 @@ bool createDirectoryIfNotExists(const std::string& dir, bool debug, const std::s
     }
 }
 
-bool authenticateUser(LauncherConfig& config, std::string& accessToken, std::string& userType) {
+// Auth round trip in flight while the rest of startup goes on
+struct PendingAuthentication {
+    std::future<std::string> validate;
+};
+
+static std::string yggdrasilPayload(const std::string& username, const std::string& authToken) {
+    json authPayload;
+    authPayload["username"] = username;
+    authPayload["password"] = authToken;
+    authPayload["clientToken"] = generateOfflineUUID(username);
+    authPayload["requestUser"] = true;
+    return authPayload.dump();
+}
+
+// Send the validate request without waiting for it, so it overlaps the bootstrap downloads and
+// the Java download. Yggdrasil is only asked once validate has named the account.
+bool startAuthentication(const LauncherConfig& config, PendingAuthentication& pending) {
     // Generate HWID
     std::string hwid = getHWID();
     if (hwid.find("ERROR") == 0) {
@@ -171,8 +199,12 @@ bool authenticateUser(LauncherConfig& config, std::string& accessToken, std::str
     const std::string validateUrl = config.api_url + "/api/auth/validate?token=" +
                                    config.auth_token + "&hwid=" + hwid;
     log("Validating token via API: " + validateUrl, config.debug, config.log_file);
+    pending.validate = httpGetAsync(validateUrl);
+    return true;
+}
 
-    const std::string validateResponse = httpGet(validateUrl);
+bool authenticateUser(LauncherConfig& config, PendingAuthentication& pending, std::string& accessToken, std::string& userType) {
+    const std::string validateResponse = pending.validate.get();
     if (validateResponse.empty()) {
         log("Empty response from validate API. Check connection/URL.", config.debug, config.log_file);
         return false;
@@ -197,14 +229,8 @@ bool authenticateUser(LauncherConfig& config, std::string& accessToken, std::str
     }
 
     // Step 2: Authenticate via Yggdrasil to get accessToken
-    const std::string yggUrl = config.api_url + "/authserver/authenticate";
-    json authPayload;
-    authPayload["username"] = config.username;
-    authPayload["password"] = config.auth_token;
-    authPayload["clientToken"] = generateOfflineUUID(config.username);
-    authPayload["requestUser"] = true;
-
-    const std::string yggResponse = httpPost(yggUrl, authPayload.dump());
+    const std::string yggResponse = httpPost(config.api_url + "/authserver/authenticate",
+                                             yggdrasilPayload(config.username, config.auth_token));
     if (!yggResponse.empty()) {
         try {
             json yggJson = json::parse(yggResponse);
@@ -326,6 +352,32 @@ int main() {
         return 1;
     }
 
+    // Shared store lets every instance on this machine reuse artifacts with a known hash
+    const DownloadSettings downloadSettings = loadDownloadSettings();
+    if (downloadSettings.artifactStore) {
+        const std::string storeDir = downloadSettings.artifactStoreDir.empty()
+            ? defaultArtifactStoreDir() : downloadSettings.artifactStoreDir;
+        ArtifactStore::getInstance().setRoot(storeDir);
+        log("Artifact store: " + storeDir, config.debug, config.log_file);
+    }
+
+    // Auth and manifest requests are admitted ahead of library and bulk transfers
+    DownloadScheduler::getInstance().configure(downloadSettings.scheduler);
+    HttpClient::getInstance().setHttp2(downloadSettings.http2);
+
+    // Rank the configured mirrors before the first download picks one
+    MirrorRegistry::getInstance().configure(downloadSettings.mirrors, "mirrors.json");
+    if (!downloadSettings.mirrors.empty()) {
+        MirrorRegistry::getInstance().probe(std::chrono::milliseconds(2000));
+        for (const std::string& line : MirrorRegistry::getInstance().describe()) {
+            logDebug("Mirror " + line, config.debug, config.log_file);
+        }
+    }
+    if (downloadSettings.scheduler.rateLimitBytesPerSecond > 0) {
+        log("Download rate limit: " + std::to_string(downloadSettings.scheduler.rateLimitBytesPerSecond / 1024) +
+            " KB/s", config.debug, config.log_file);
+    }
+
     log("Starting PurrLauncher...", config.debug, config.log_file);
 
     // Create plugins directory and load plugins
@@ -339,15 +391,42 @@ int main() {
     // Load plugins using RAII manager
     pluginManager.loadPlugins(pluginsDir, config.debug, config.log_file);
 
-    // Download and extract Java if not loaded
+    // Validate only needs the network: let it run while Java and bootstrap files load
+    PendingAuthentication authentication;
+    if (!startAuthentication(config, authentication)) {
+        return 1;
+    }
+
+    // Small bootstrap artifacts come in on the event loop while Java downloads
+    const std::string librariesDir = config.gameDir + "libraries/";
+    createDirectoryIfNotExists(librariesDir, config.debug, config.log_file);
+
+    const std::string authlibPath = librariesDir + "authlib-injector.jar";
+    std::vector<std::future<DownloadResult>> bootstrapDownloads;
+    if (!fs::exists(authlibPath)) {
+        constexpr const char* authlibUrl = "https://authlib-injector.yushi.moe/artifact/53/authlib-injector-1.2.5.jar";
+        log("Downloading authlib-injector from " + std::string(authlibUrl) + "...", config.debug, config.log_file);
+        bootstrapDownloads.push_back(downloadAsync({authlibUrl, authlibPath}));
+    }
+
+    // Download and extract Java if not loaded (large single archive, fetched as parallel ranges)
     if (!javaLoaded && !downloadAndExtractJava(config.javaPath)) {
         log("Failed to download/extract Java.", config.debug, config.log_file);
         return 1;
     }
 
+    bool bootstrapOk = true;
+    for (auto& download : bootstrapDownloads) {
+        bootstrapOk = download.get().ok() && bootstrapOk;
+    }
+    if (!bootstrapOk) {
+        log("Failed to download bootstrap artifacts.", config.debug, config.log_file);
+        return 1;
+    }
+
     // Authenticate user
     std::string accessToken, userType;
-    if (!authenticateUser(config, accessToken, userType)) {
+    if (!authenticateUser(config, authentication, accessToken, userType)) {
         return 1;
     }
 
@@ -362,22 +441,6 @@ int main() {
         return 1;
     }
 
-    // Create libraries directory and download authlib-injector
-    const std::string librariesDir = config.gameDir + "libraries/";
-    createDirectoryIfNotExists(librariesDir, config.debug, config.log_file);
-
-    const std::string authlibPath = librariesDir + "authlib-injector.jar";
-    if (!fs::exists(authlibPath)) {
-        constexpr const char* authlibUrl = "https://authlib-injector.yushi.moe/artifact/53/authlib-injector-1.2.5.jar";
-        log("Downloading authlib-injector from " + std::string(authlibUrl) + "...", config.debug, config.log_file);
-
-        if (!downloadFile(authlibUrl, authlibPath)) {
-            log("Failed to download authlib-injector.", config.debug, config.log_file);
-            return 1;
-        }
-        log("Downloaded authlib-injector successfully.", config.debug, config.log_file);
-    }
-
     // Save configuration
     saveConfig(config.javaPath, config.username, config.uuid, config.debug,
               config.max_ram, config.pack_url, config.pack_manifest_url,
@@ -391,6 +454,24 @@ int main() {
         return 1;
     }
 
+    // Report how many requests rode on an existing connection
+    const HttpClientStats httpStats = HttpClient::getInstance().getStats();
+    log("HTTP connections: " + std::to_string(httpStats.newConnections) + " new, " +
+        std::to_string(httpStats.reusedConnections) + " reused across " +
+        std::to_string(httpStats.transfers) + " request(s).", config.debug, config.log_file);
+    for (const auto& [host, stats] : HttpClient::getInstance().getHostStats()) {
+        logDebug(host + ": " + std::to_string(stats.requests) + " request(s), " +
+                 std::to_string(stats.http2Streams) + " as HTTP/2 streams, over " +
+                 std::to_string(stats.newConnections) + " new connection(s)", config.debug, config.log_file);
+    }
+
+    const ArtifactStoreStats storeStats = ArtifactStore::getInstance().getStats();
+    if (storeStats.hits > 0 || storeStats.added > 0) {
+        log("Artifact store: " + std::to_string(storeStats.hits) + " installed (" +
+            std::to_string(storeStats.bytesReused / (1024 * 1024)) + " MB reused), " +
+            std::to_string(storeStats.added) + " added.", config.debug, config.log_file);
+    }
+
     // Launch Minecraft
     launchMinecraft(config.javaPath, config.username, config.uuid, config.version,
                    config.debug, config.max_ram, config.gameDir, config.log_file,
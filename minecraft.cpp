@@ -3,8 +3,10 @@
 #include "include/minecraft.h"
 #include "include/download.h"
 #include "include/archive.h"
+#include "include/hash.h"
 #include "include/logging.h"
 #include "include/crypto.h"
+#include "include/config.h"
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <vector>
@@ -19,6 +21,8 @@
 #include <sstream>
 #include <memory>
 #include <algorithm>
+#include <cctype>
+#include <chrono>
 
 using json = nlohmann::json;
 namespace fs = std::filesystem;
@@ -69,6 +73,84 @@ public:
     void flush() { file.flush(); }
 };
 
+// Modification time as a plain number, -1 if the path is missing
+static std::int64_t modificationTime(const std::string& path) {
+    std::error_code ec;
+    const auto time = fs::last_write_time(path, ec);
+    return ec ? -1 : static_cast<std::int64_t>(time.time_since_epoch().count());
+}
+
+// What a resolved classpath depends on besides its own entries: the version JSON's digest and
+// the natives/ directory, whose time moves whenever a native is added, removed or replaced
+static json classpathFingerprint(const std::string& gameDir, const std::string& version,
+                                 const std::string& jsonText) {
+    StreamingHash hash(HashAlgorithm::SHA256);
+    hash.update(jsonText.data(), jsonText.size());
+    return {
+        {"version", version},
+        {"json_sha256", hash.finish()},
+        {"natives_mtime", modificationTime(gameDir + "natives")}
+    };
+}
+
+// Size and modification time of one classpath entry; null if it is missing
+static json classpathEntryStamp(const std::string& path) {
+    std::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    if (ec) return nullptr;
+    const auto time = fs::last_write_time(path, ec);
+    if (ec) return nullptr;
+    return {size, static_cast<std::int64_t>(time.time_since_epoch().count())};
+}
+
+// classpath.txt is still what the fingerprint was taken for, every jar on it is still the file
+// that was there, and every library left off it for lack of a download is still absent: one
+// stat per entry instead of parsing the JSON and resolving libraries
+static bool classpathCacheValid(const std::string& gameDir, const json& fingerprint) {
+    try {
+        std::ifstream ifs(gameDir + "classpath_cache.json");
+        if (!ifs.is_open()) return false;
+        const json cached = json::parse(ifs);
+        std::error_code ec;
+        const auto size = fs::file_size(gameDir + "classpath.txt", ec);
+        if (ec || size == 0 || cached.value("fingerprint", json()) != fingerprint ||
+            cached.value("classpath_size", std::uint64_t{0}) != size) {
+            return false;
+        }
+
+        const json& entries = cached.at("entries");
+        if (!entries.is_object() || entries.empty()) return false;
+        for (const auto& [path, stamp] : entries.items()) {
+            if (classpathEntryStamp(path) != stamp) return false;
+        }
+        return true;
+    } catch (const json::exception&) {
+        return false;
+    }
+}
+
+// Missing libraries are stored with a null stamp, so one that turns up later invalidates the cache
+static void saveClasspathCache(const std::string& gameDir, const json& fingerprint, std::uint64_t classpathSize,
+                               const std::vector<std::string>& classpathEntries,
+                               const std::vector<std::string>& missingLibraries) {
+    json entries = json::object();
+    for (const auto& path : classpathEntries) {
+        json stamp = classpathEntryStamp(path);
+        if (stamp.is_null()) return;  // Not all there: nothing worth caching
+        entries[path] = std::move(stamp);
+    }
+    for (const auto& path : missingLibraries) {
+        if (!classpathEntryStamp(path).is_null()) return;  // Appeared meanwhile; resolve it next launch
+        entries[path] = nullptr;
+    }
+
+    FileManager cacheFile(gameDir + "classpath_cache.json");
+    if (cacheFile.isOpen()) {
+        cacheFile << json{{"fingerprint", fingerprint}, {"classpath_size", classpathSize}, {"entries", entries}}.dump(2);
+        cacheFile.flush();
+    }
+}
+
 // Optimized classpath building with better error handling
 bool buildClasspathFromJson(const std::string& gameDir, const std::string& version) {
     const std::string jsonPath = gameDir + "versions/" + version + "/" + version + ".json";
@@ -78,14 +160,27 @@ bool buildClasspathFromJson(const std::string& gameDir, const std::string& versi
         return false;
     }
 
-    json j;
-    try {
-        std::ifstream ifs(jsonPath);
+    std::string jsonText;
+    {
+        std::ifstream ifs(jsonPath, std::ios::binary);
         if (!ifs.is_open()) {
             std::cerr << "Failed to open: " << jsonPath << std::endl;
             return false;
         }
-        ifs >> j;
+        jsonText.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+
+    // Unchanged install: reuse the resolved classpath without parsing the JSON or resolving libraries
+    if (classpathCacheValid(gameDir, classpathFingerprint(gameDir, version, jsonText))) {
+        std::cout << "Version and libraries unchanged, reusing classpath.txt" << std::endl;
+        return true;
+    }
+    std::error_code removeError;
+    fs::remove(gameDir + "classpath_cache.json", removeError);
+
+    json j;
+    try {
+        j = json::parse(jsonText);
     } catch (const json::exception& e) {
         std::cerr << "JSON parse error: " << e.what() << std::endl;
         return false;
@@ -98,15 +193,22 @@ bool buildClasspathFromJson(const std::string& gameDir, const std::string& versi
     classpathEntries.reserve(100); // Reserve space for typical number of libraries
 
     const std::string libDir = gameDir + "libraries/";
+    std::vector<DownloadJob> libraryDownloads;
+    std::vector<NativeDownload> nativeDownloads;
+    std::vector<std::string> missingLibraries;
 
     if (j.contains("libraries") && j["libraries"].is_array()) {
         for (const auto& lib : j["libraries"]) {
-            if (!processLibrary(lib, libDir, classpathEntries, gameDir)) {
+            if (!processLibrary(lib, libDir, classpathEntries, gameDir, libraryDownloads, nativeDownloads,
+                                missingLibraries)) {
                 continue; // Skip problematic libraries but continue processing
             }
         }
     }
 
+    // Fetch everything missing in one concurrent batch
+    const bool librariesComplete = fetchQueuedLibraries(libraryDownloads, nativeDownloads, classpathEntries, gameDir);
+
     // Add client JAR
     const std::string clientPath = gameDir + "versions/" + version + "/" + version + ".jar";
     if (fs::exists(clientPath)) {
@@ -141,12 +243,41 @@ bool buildClasspathFromJson(const std::string& gameDir, const std::string& versi
         return false;
     }
 
+    // Taken after the downloads, so the next launch compares against the completed install.
+    // A failed download is not cached: the next launch retries it.
+    if (librariesComplete) {
+        saveClasspathCache(gameDir, classpathFingerprint(gameDir, version, jsonText), cp.size(), classpathEntries,
+                           missingLibraries);
+    }
+    return true;
+}
+
+// Build a download job from a library artifact/classifier JSON object
+static bool makeDownloadJob(const json& artifact, const std::string& localPath, DownloadJob& job) {
+    if (!artifact.contains("url") || !artifact["url"].is_string()) {
+        return false;
+    }
+
+    job.url = artifact["url"].get<std::string>();
+    if (job.url.empty()) {
+        return false; // Generated by an installer, nothing to fetch
+    }
+
+    job.outputPath = localPath;
+    if (artifact.contains("size") && artifact["size"].is_number_unsigned()) {
+        job.expectedSize = artifact["size"].get<std::uint64_t>();
+    }
+    if (artifact.contains("sha1") && artifact["sha1"].is_string()) {
+        job.sha1 = artifact["sha1"].get<std::string>();
+    }
     return true;
 }
 
 // Helper function to process individual library entries
 bool processLibrary(const json& lib, const std::string& libDir,
-                   std::vector<std::string>& classpathEntries, const std::string& gameDir) {
+                   std::vector<std::string>& classpathEntries, const std::string& gameDir,
+                   std::vector<DownloadJob>& libraryDownloads, std::vector<NativeDownload>& nativeDownloads,
+                   std::vector<std::string>& missingLibraries) {
     // Check library rules for OS compatibility
     if (!isLibraryCompatible(lib)) {
         return false;
@@ -161,15 +292,19 @@ bool processLibrary(const json& lib, const std::string& libDir,
                 const std::string localPath = libDir + path;
                 if (fs::exists(localPath)) {
                     classpathEntries.push_back(localPath);
+                } else if (DownloadJob job; makeDownloadJob(lib["downloads"]["artifact"], localPath, job)) {
+                    libraryDownloads.push_back(std::move(job));
+                    classpathEntries.push_back(localPath);
                 } else {
                     std::cerr << "Missing library: " << localPath << std::endl;
+                    missingLibraries.push_back(localPath);
                 }
             }
         }
     }
 
     // Handle natives
-    processNatives(lib, gameDir);
+    processNatives(lib, gameDir, nativeDownloads);
     return true;
 }
 
@@ -230,7 +365,7 @@ std::string getLibraryPath(const json& lib) {
 }
 
 // Process native libraries
-void processNatives(const json& lib, const std::string& gameDir) {
+void processNatives(const json& lib, const std::string& gameDir, std::vector<NativeDownload>& nativeDownloads) {
     if (!lib.contains("natives") || !lib["natives"].contains("windows")) {
         return;
     }
@@ -241,19 +376,87 @@ void processNatives(const json& lib, const std::string& gameDir) {
         return;
     }
 
-    const std::string url = lib["downloads"]["classifiers"][classifier]["url"];
-    const std::string tempJar = gameDir + "temp_natives.jar";
+    const json& artifact = lib["downloads"]["classifiers"][classifier];
     const std::string nativesDir = gameDir + "natives/";
 
     if (!fs::exists(nativesDir) || fs::is_empty(nativesDir)) {
-        std::cout << "Downloading natives from " << url << "..." << std::endl;
-        if (downloadFile(url, tempJar)) {
-            std::cout << "Extracting natives..." << std::endl;
-            if (extractArchive(tempJar, nativesDir)) {
-                fs::remove(tempJar);
+        // Each natives jar gets its own temp name so a batch can fetch them side by side
+        const std::string jarName = classifier + "-" + std::to_string(nativeDownloads.size()) + ".jar";
+        NativeDownload native;
+        if (!makeDownloadJob(artifact, gameDir + "natives_temp/" + jarName, native.job)) return;
+
+        if (lib.contains("extract") && lib["extract"].contains("exclude") && lib["extract"]["exclude"].is_array()) {
+            for (const auto& prefix : lib["extract"]["exclude"]) {
+                if (prefix.is_string()) native.exclude.push_back(prefix.get<std::string>());
             }
+        } else {
+            native.exclude.push_back("META-INF/");
         }
+        nativeDownloads.push_back(std::move(native));
+    }
+}
+
+// Native libraries only: skips the version JSON's excluded prefixes and everything that
+// is not a shared library (manifests, checksums, license files)
+static bool isNativeEntry(const ZipEntryInfo& entry, const std::vector<std::string>& exclude) {
+    if (entry.isDirectory) return false;
+    for (const auto& prefix : exclude) {
+        if (entry.name.compare(0, prefix.size(), prefix) == 0) return false;
     }
+    std::string extension = fs::path(entry.name).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".dll" || extension == ".so" || extension == ".dylib" || extension == ".jnilib";
+}
+
+// Download queued libraries and natives together, then extract the natives
+bool fetchQueuedLibraries(const std::vector<DownloadJob>& libraryDownloads,
+                          const std::vector<NativeDownload>& nativeDownloads,
+                          std::vector<std::string>& classpathEntries, const std::string& gameDir) {
+    if (libraryDownloads.empty() && nativeDownloads.empty()) {
+        return true;
+    }
+
+    std::vector<DownloadJob> batch;
+    batch.reserve(libraryDownloads.size() + nativeDownloads.size());
+    batch.insert(batch.end(), libraryDownloads.begin(), libraryDownloads.end());
+    for (const auto& native : nativeDownloads) batch.push_back(native.job);
+
+    std::cout << "Downloading " << libraryDownloads.size() << " libraries and "
+             << nativeDownloads.size() << " natives..." << std::endl;
+    const DownloadReport report = downloadBatch(batch);
+
+    const std::string nativesDir = gameDir + "natives/";
+    for (const auto& native : nativeDownloads) {
+        const std::string& jarPath = native.job.outputPath;
+        if (!fs::exists(jarPath)) continue;
+
+        ZipReader reader;
+        const auto filter = [&](const ZipEntryInfo& entry) { return isNativeEntry(entry, native.exclude); };
+        if (!reader.open(jarPath) || !reader.extract(nativesDir, filter)) {
+            std::cerr << "Failed to extract natives from " << jarPath << ": " << reader.error() << std::endl;
+            continue;
+        }
+        std::cout << "Extracted " << reader.filesExtracted() << " of " << reader.entries().size()
+                 << " entries from " << fs::path(jarPath).filename().string() << std::endl;
+        reader.close();  // Unmap before deleting; Windows refuses to remove a mapped file
+        fs::remove(jarPath);
+    }
+
+    std::error_code ec;
+    fs::remove(gameDir + "natives_temp/", ec); // Only succeeds once every jar was extracted
+
+    // Drop classpath entries whose download failed
+    if (!report.ok()) {
+        classpathEntries.erase(std::remove_if(classpathEntries.begin(), classpathEntries.end(),
+            [](const std::string& entry) {
+                if (fs::exists(entry)) return false;
+                std::cerr << "Missing library: " << entry << std::endl;
+                return true;
+            }), classpathEntries.end());
+    }
+
+    return report.ok();
 }
 
 void launchMinecraft(const std::string& javaPath, const std::string& username, const std::string& uuid,
@@ -639,6 +842,94 @@ void executeLaunchCommand(const std::string& javaPath, const std::string& javawP
     system(command.c_str());
 }
 
+// Folders owned by the pack: an update makes their contents match the archive exactly
+static const std::vector<std::string> PACK_MANAGED_DIRS = {"config", "fancymenu_data", "mods"};
+
+// An installed pack is diffed against the new archive, so unchanged files are linked, not rewritten
+static bool packInstalled(const std::string& gameDir) {
+    return fs::exists(gameDir + "mods") && fs::exists(gameDir + "config");
+}
+
+// Staging tree the next pack is extracted into before it is swapped in
+static std::string packStagingDir(const std::string& gameDir) {
+    return gameDir + ".pack_staging/";
+}
+
+// While a swap is in progress the old pack lives in a .pack_trash-<n> tree: the pack folders and
+// servers.dat by name, and under .replaced/ every other file the new pack overwrote. Renaming the
+// tree to .pack_retired-<n> commits the swap; only retired trees are ever deleted.
+static constexpr const char* PACK_TRASH_PREFIX = ".pack_trash-";
+static constexpr const char* PACK_RETIRED_PREFIX = ".pack_retired-";
+
+// Put the pack held in trashDir back into gameDir. Whatever the swap already moved in is set aside
+// under trashDir/.discarded/. False if something could not be moved back; trashDir is kept then.
+static bool restoreRetiredPack(const std::string& gameDir, const std::string& trashDir,
+                               bool debug, const std::string& log_file) {
+    std::vector<std::string> retired = {"servers.dat"};
+    retired.insert(retired.end(), PACK_MANAGED_DIRS.begin(), PACK_MANAGED_DIRS.end());
+
+    const std::string discardDir = trashDir + ".discarded/";
+    std::error_code ec;
+    fs::create_directories(discardDir, ec);
+    bool restored = !ec;
+    for (const auto& name : retired) {
+        if (!fs::exists(trashDir + name, ec)) continue;
+        if (fs::exists(gameDir + name, ec)) fs::rename(gameDir + name, discardDir + name, ec);
+        if (!ec) fs::rename(trashDir + name, gameDir + name, ec);
+        if (ec) {
+            log("Failed to restore " + name + ": " + ec.message(), debug, log_file);
+            restored = false;
+        }
+    }
+    if (fs::exists(trashDir + ".replaced", ec) && !moveTreeInto(trashDir + ".replaced", gameDir, discardDir + ".replaced")) {
+        log("Failed to restore files replaced by the pack update", debug, log_file);
+        restored = false;
+    }
+    return restored;
+}
+
+// Rename a trash tree to its retired name and delete it in the background
+static void retireTrash(const std::string& trashDir, bool debug, const std::string& log_file) {
+    const fs::path trash = fs::path(trashDir).parent_path();
+    std::string name = trash.filename().string();
+    name.replace(0, std::string(PACK_TRASH_PREFIX).size(), PACK_RETIRED_PREFIX);
+    const fs::path retired = trash.parent_path() / name;
+
+    std::error_code ec;
+    fs::rename(trash, retired, ec);
+    if (!ec) {
+        removeTreeInBackground(retired.string());
+        return;
+    }
+    // Left under its trash name it would be restored over the new pack on the next launch
+    fs::remove_all(trash, ec);
+    if (ec) log("Failed to delete " + trash.string() + ": " + ec.message(), debug, log_file);
+}
+
+// Clean up after an interrupted update: a swap that never committed is rolled back, and the
+// staging tree and retired pack folders are deleted
+static void removeUpdateLeftovers(const std::string& gameDir, bool debug, const std::string& log_file) {
+    std::error_code ec;
+    std::vector<fs::path> trashTrees;
+    for (const auto& entry : fs::directory_iterator(gameDir, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind(PACK_TRASH_PREFIX, 0) == 0) trashTrees.push_back(entry.path());
+        if (name.rfind(PACK_RETIRED_PREFIX, 0) == 0) removeTreeInBackground(entry.path().string());
+    }
+    for (const auto& trash : trashTrees) {
+        log("Restoring the pack left by an interrupted update", debug, log_file);
+        if (!restoreRetiredPack(gameDir, trash.string() + "/", debug, log_file)) continue;  // Tried again next launch
+        retireTrash(trash.string() + "/", debug, log_file);
+    }
+
+    const std::string staging = packStagingDir(gameDir);
+    if (fs::exists(staging, ec)) {
+        const std::string retired = gameDir + PACK_RETIRED_PREFIX + "staging";
+        fs::rename(staging, retired, ec);
+        removeTreeInBackground(ec ? staging : retired);
+    }
+}
+
 bool updatePack(const std::string& pack_url, const std::string& pack_manifest_url,
                std::string& pack_version, const std::string& gameDir,
                bool debug, const std::string& log_file) {
@@ -648,17 +939,22 @@ bool updatePack(const std::string& pack_url, const std::string& pack_manifest_ur
         return true;
     }
 
-    // Download remote manifest with better error handling
+    // Fetch remote manifest; the previous copy is kept so an unchanged manifest costs a 304
     const std::string temp_manifest_path = gameDir + "remote_manifest.json";
     log("Downloading remote manifest from " + pack_manifest_url + "...", debug, log_file);
 
-    if (!downloadFile(pack_manifest_url, temp_manifest_path)) {
+    FetchStatus manifestStatus = downloadFileIfModified(pack_manifest_url, temp_manifest_path);
+    if (manifestStatus == FetchStatus::Failed) {
         log("Failed to fetch remote manifest.", debug, log_file);
         return false;
     }
+    if (manifestStatus == FetchStatus::NotModified) {
+        log("Remote manifest not modified since last check.", debug, log_file);
+    }
 
     // Parse remote version with RAII
     std::string remote_version;
+    std::string pack_sha256;
     {
         std::ifstream manifest_ifs(temp_manifest_path);
         if (!manifest_ifs.is_open()) {
@@ -671,6 +967,7 @@ bool updatePack(const std::string& pack_url, const std::string& pack_manifest_ur
             json manifest_j;
             manifest_ifs >> manifest_j;
             remote_version = manifest_j.value("version", "0.0.0");
+            pack_sha256 = manifest_j.value("pack_sha256", "");
         } catch (const json::exception& e) {
             log("JSON parse error in manifest: " + std::string(e.what()), debug, log_file);
             fs::remove(temp_manifest_path);
@@ -692,7 +989,6 @@ bool updatePack(const std::string& pack_url, const std::string& pack_manifest_ur
     // Only skip download if versions match AND all files exist
     if (remote_version == pack_version && packFilesExist) {
         log("Pack is up to date (" + pack_version + ").", debug, log_file);
-        fs::remove(temp_manifest_path);
         return true;
     }
 
@@ -702,80 +998,259 @@ bool updatePack(const std::string& pack_url, const std::string& pack_manifest_ur
         log("Pack version mismatch. Updating from " + pack_version + " to " + remote_version, debug, log_file);
     }
 
-    // Clean up directories more efficiently
-    if (!cleanupDirectoriesForUpdate(gameDir, debug, log_file)) {
-        log("Failed to cleanup directories for update", debug, log_file);
-        fs::remove(temp_manifest_path);
-        return false;
-    }
-
-    // Download and extract pack
-    if (!downloadAndExtractPack(pack_url, gameDir, debug, log_file)) {
-        fs::remove(temp_manifest_path);
+    // Download and extract pack; the installed one stays untouched until the new one is staged
+    if (!downloadAndExtractPack(pack_url, gameDir, debug, log_file, pack_sha256)) {
         return false;
     }
 
     // Update version
     pack_version = remote_version;
     log("Pack updated to " + pack_version + ".", debug, log_file);
+    return true;
+}
 
-    fs::remove(temp_manifest_path);
+// Move servers.dat (mandatory overwrite) and the pack folders into trashDir so a staged pack can
+// take their place. Renames only, so this takes milliseconds; on failure, e.g. a mod file still
+// open in a running game, everything already moved is put back.
+bool cleanupDirectoriesForUpdate(const std::string& gameDir, const std::string& trashDir,
+                                 bool debug, const std::string& log_file) {
+    std::vector<std::string> retired = {"servers.dat"};
+    retired.insert(retired.end(), PACK_MANAGED_DIRS.begin(), PACK_MANAGED_DIRS.end());
+
+    std::error_code ec;
+    fs::create_directories(trashDir, ec);
+    std::vector<std::string> moved;
+    for (const auto& name : retired) {
+        if (!fs::exists(gameDir + name, ec)) continue;
+        fs::rename(gameDir + name, trashDir + name, ec);
+        if (ec) {
+            log("Failed to move " + name + " out of the way: " + ec.message(), debug, log_file);
+            for (const auto& restore : moved) {
+                std::error_code ignored;
+                fs::rename(trashDir + restore, gameDir + restore, ignored);
+            }
+            return false;
+        }
+        moved.push_back(name);
+    }
     return true;
 }
 
-// Helper function to cleanup directories for update
-bool cleanupDirectoriesForUpdate(const std::string& gameDir, bool debug, const std::string& log_file) {
-    // Define folders to delete with better container
-    const std::vector<std::string> foldersToDelete = {"config", "fancymenu_data", "mods"};
+// Swap a verified staging tree into gameDir: the pack folders are replaced whole by rename,
+// anything else the pack ships is merged over the instance, and the old folders are deleted
+// in the background. Until the trash tree is retired every step can be undone, here on failure
+// or by removeUpdateLeftovers after a crash.
+static bool installStagedPack(const std::string& stagingDir, const std::string& gameDir,
+                              bool debug, const std::string& log_file) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::string trashDir = gameDir + PACK_TRASH_PREFIX +
+        std::to_string(std::chrono::system_clock::now().time_since_epoch().count()) + "/";
+    if (!cleanupDirectoriesForUpdate(gameDir, trashDir, debug, log_file)) {
+        std::error_code ec;
+        fs::remove(trashDir, ec);  // Empty again after its own rollback; kept otherwise, to be restored
+        return false;
+    }
 
-    // Remove servers.dat file
-    const std::string serversFile = gameDir + "servers.dat";
-    if (fs::exists(serversFile)) {
-        try {
-            fs::remove(serversFile);
-            log("Deleted servers.dat for mandatory overwrite.", debug, log_file);
-        } catch (const fs::filesystem_error& e) {
-            log("Failed to delete servers.dat: " + std::string(e.what()), debug, log_file);
+    auto rollBack = [&]() {
+        if (restoreRetiredPack(gameDir, trashDir, debug, log_file)) {
+            retireTrash(trashDir, debug, log_file);
+        } else {
+            log("Installed pack left in " + trashDir + "; restored on the next launch", debug, log_file);
         }
-    }
+        return false;
+    };
 
-    // Remove directories
-    for (const auto& folder : foldersToDelete) {
-        const std::string dirPath = gameDir + folder + "/";
-        if (fs::exists(dirPath)) {
-            try {
-                fs::remove_all(dirPath);
-                log("Deleted " + folder + " folder for mandatory overwrite.", debug, log_file);
-            } catch (const fs::filesystem_error& e) {
-                log("Failed to delete " + folder + ": " + std::string(e.what()), debug, log_file);
-                // Continue with other folders
-            }
+    for (const auto& folder : PACK_MANAGED_DIRS) {
+        std::error_code ec;
+        if (!fs::exists(stagingDir + folder, ec)) continue;
+        fs::rename(stagingDir + folder, gameDir + folder, ec);
+        if (ec) {
+            log("Failed to move new " + folder + " into place: " + ec.message(), debug, log_file);
+            return rollBack();
         }
     }
+    if (!moveTreeInto(stagingDir, gameDir, trashDir + ".replaced")) {
+        log("Failed to move extracted pack into place.", debug, log_file);
+        return rollBack();
+    }
+    retireTrash(trashDir, debug, log_file);
 
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::stringstream ss;
+    ss << "Swapped new pack into place in " << std::fixed << std::setprecision(1) << ms << " ms";
+    log(ss.str(), debug, log_file);
     return true;
 }
 
+// Feeds the pack download straight into the zip or tar parser, picked from the first bytes
+class PackStreamConsumer : public DownloadConsumer {
+private:
+    ZipStreamExtractor& zip;
+    TarStreamExtractor& tar;
+    std::string head;  // Bytes held back until the format is known
+    ArchiveFormat format = ArchiveFormat::Unknown;
+
+    bool isTarball() const { return format == ArchiveFormat::Gzip || format == ArchiveFormat::Zstd; }
+
+    bool dispatch(const char* data, size_t length) {
+        return isTarball() ? tar.feed(data, length) : zip.feed(data, length);
+    }
+
+public:
+    PackStreamConsumer(ZipStreamExtractor& zipExtractor, TarStreamExtractor& tarExtractor)
+        : zip(zipExtractor), tar(tarExtractor) {}
+
+    bool begin() override {
+        head.clear();
+        format = ArchiveFormat::Unknown;
+        return zip.reset() && tar.reset();
+    }
+
+    bool consume(const char* data, size_t length) override {
+        if (head.size() < 4) {
+            const size_t count = std::min(length, 4 - head.size());
+            head.append(data, count);
+            data += count;
+            length -= count;
+            if (head.size() < 4) return true;
+            format = detectArchiveFormat(head.data(), head.size());
+            if (!dispatch(head.data(), head.size())) return false;
+        }
+        return length == 0 || dispatch(data, length);
+    }
+
+    bool finish() override {
+        if (head.size() < 4 && !head.empty() && !zip.feed(head.data(), head.size())) return false;
+        return isTarball() ? tar.finish() : zip.finish();
+    }
+
+    const std::string& error() const { return isTarball() ? tar.error() : zip.error(); }
+    bool unsupported() const { return !isTarball() && zip.unsupported(); }
+    size_t entriesExtracted() const { return isTarball() ? tar.entriesExtracted() : zip.entriesExtracted(); }
+    std::uint64_t bytesExtracted() const { return isTarball() ? tar.bytesExtracted() : zip.bytesExtracted(); }
+};
+
+enum class PackStreamResult {
+    Staged,
+    Unsupported,  // Archive layout needs the file-based extractor
+    Failed
+};
+
+// Download and unpack in one pass: entries are extracted into the staging directory as they
+// arrive, and the result counts only once the whole archive (and its SHA-256) checked out
+static PackStreamResult streamPack(const std::string& pack_url, const std::string& gameDir, bool keepArchive,
+                                   bool debug, const std::string& log_file, const std::string& expected_sha256) {
+    const std::string pack_path = gameDir + "pack.zip";
+    const std::string staging_dir = packStagingDir(gameDir);
+    ZipStreamExtractor zipExtractor(staging_dir);
+    TarStreamExtractor tarExtractor(staging_dir);
+    PackStreamConsumer consumer(zipExtractor, tarExtractor);
+
+    log("Streaming pack from " + pack_url + " into extraction...", debug, log_file);
+    const auto start = std::chrono::steady_clock::now();
+    const DownloadResult result = downloadStreamed(pack_url, consumer, HashAlgorithm::SHA256, expected_sha256,
+                                                   keepArchive ? pack_path : "");
+    if (!result.ok()) {
+        std::error_code ec;
+        fs::remove_all(staging_dir, ec);
+        if (!consumer.error().empty()) {
+            log("Streaming extraction stopped: " + consumer.error(), debug, log_file);
+        }
+        return consumer.unsupported() ? PackStreamResult::Unsupported : PackStreamResult::Failed;
+    }
+
+    if (result.status == FetchStatus::NotModified) {
+        log("Pack archive not modified, extracted cached pack.zip", debug, log_file);
+    }
+    if (!result.digest.empty()) {
+        log("pack.zip SHA-256: " + result.digest + (expected_sha256.empty() ? "" : " (verified)"), debug, log_file);
+    }
+
+    if (!keepArchive && fs::exists(pack_path)) {
+        std::error_code ec;
+        fs::remove(pack_path, ec); // Stale copy of an older pack
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::stringstream ss;
+    ss << "Streamed and extracted " << consumer.entriesExtracted() << " entries ("
+       << std::fixed << std::setprecision(2) << (consumer.bytesExtracted() / (1024.0 * 1024.0))
+       << " MB) in " << seconds << " s";
+    log(ss.str(), debug, log_file);
+    return PackStreamResult::Staged;
+}
+
+// Packs may also be published as .tar.gz / .tar.zst under the same name
+static bool isTarballFile(const std::string& path) {
+    char magic[4] = {};
+    std::ifstream in(path, std::ios::binary);
+    in.read(magic, sizeof(magic));
+    const ArchiveFormat format = detectArchiveFormat(magic, static_cast<size_t>(in.gcount()));
+    return format == ArchiveFormat::Gzip || format == ArchiveFormat::Zstd;
+}
+
+// Essential modpack directories must exist after extraction
+static bool packDirectoriesPresent(const std::string& gameDir, bool debug, const std::string& log_file) {
+    const std::vector<std::string> essentialDirs = {"mods", "config"};
+    bool allDirsExist = true;
+
+    for (const auto& dir : essentialDirs) {
+        const std::string dirPath = gameDir + dir;
+        if (!fs::exists(dirPath)) {
+            log("Essential directory missing after extraction: " + dir, debug, log_file);
+            allDirsExist = false;
+        }
+    }
+    return allDirsExist;
+}
+
 // Helper function to download and extract pack with safety checks
 bool downloadAndExtractPack(const std::string& pack_url, const std::string& gameDir,
-                           bool debug, const std::string& log_file) {
+                           bool debug, const std::string& log_file, const std::string& expected_sha256) {
     const std::string pack_path = gameDir + "pack.zip";
     const std::string temp_pack_path = gameDir + "pack.zip.tmp";
+    const std::string staging_dir = packStagingDir(gameDir);
+    const DownloadSettings settings = loadDownloadSettings();
+    removeUpdateLeftovers(gameDir, debug, log_file);
 
-    // Remove existing pack.zip and temp files if they exist
-    for (const auto& path : {pack_path, temp_pack_path}) {
-        if (fs::exists(path)) {
-            try {
-                log("Removing existing file: " + path, debug, log_file);
-                fs::remove(path);
-            } catch (const fs::filesystem_error& e) {
-                log("Failed to remove existing file: " + std::string(e.what()), debug, log_file);
-            }
+    // Remove leftover temp file; pack.zip itself is kept as the cached copy for the conditional request
+    if (fs::exists(temp_pack_path)) {
+        try {
+            log("Removing existing file: " + temp_pack_path, debug, log_file);
+            fs::remove(temp_pack_path);
+        } catch (const fs::filesystem_error& e) {
+            log("Failed to remove existing file: " + std::string(e.what()), debug, log_file);
+        }
+    }
+
+    // Streaming writes every entry; an installed pack is cheaper to diff against the downloaded archive
+    const bool incremental = packInstalled(gameDir);
+    if (settings.streamPackExtract && incremental) {
+        log("Pack already installed, staging changed files only", debug, log_file);
+    } else if (settings.streamPackExtract) {
+        switch (streamPack(pack_url, gameDir, settings.keepPackArchive, debug, log_file, expected_sha256)) {
+            case PackStreamResult::Staged:
+                if (packDirectoriesPresent(staging_dir, debug, log_file)) {
+                    return installStagedPack(staging_dir, gameDir, debug, log_file);
+                }
+                log("Pack extraction incomplete - missing essential directories.", debug, log_file);
+                removeTreeInBackground(staging_dir);
+                return false;
+            case PackStreamResult::Unsupported:
+                log("Pack archive cannot be streamed, falling back to download-then-extract", debug, log_file);
+                break;
+            case PackStreamResult::Failed:
+                log("Failed to download pack.", debug, log_file);
+                return false;
         }
     }
 
     log("Downloading updated pack from " + pack_url + "...", debug, log_file);
-    if (!downloadFile(pack_url, pack_path)) {
+    // SHA-256 is computed while the archive streams to disk; a mismatch fails the download
+    const DownloadResult packResult = downloadFileVerified(pack_url, pack_path, HashAlgorithm::SHA256,
+                                                           expected_sha256, true);
+    const FetchStatus packStatus = packResult.status;
+    if (packStatus == FetchStatus::Failed) {
         log("Failed to download pack.", debug, log_file);
 
         // Clean up failed download
@@ -792,7 +1267,14 @@ bool downloadAndExtractPack(const std::string& pack_url, const std::string& game
         return false;
     }
 
-    log("Download completed successfully", debug, log_file);
+    if (packStatus == FetchStatus::NotModified) {
+        log("Pack archive not modified, reusing cached pack.zip", debug, log_file);
+    } else {
+        log("Download completed successfully", debug, log_file);
+    }
+    if (!packResult.digest.empty()) {
+        log("pack.zip SHA-256: " + packResult.digest + (expected_sha256.empty() ? "" : " (verified)"), debug, log_file);
+    }
 
     // Verify that pack.zip was actually downloaded and has content
     if (!fs::exists(pack_path)) {
@@ -826,10 +1308,27 @@ bool downloadAndExtractPack(const std::string& pack_url, const std::string& game
 
     log("Extracting pack...", debug, log_file);
 
-    // Try to extract the archive
+    // Extract into the staging tree; files already installed unchanged are hard-linked, not rewritten
     bool extractSuccess = false;
     try {
-        extractSuccess = extractArchive(pack_path, gameDir);
+        const auto start = std::chrono::steady_clock::now();
+        if (isTarballFile(pack_path)) {
+            // Tarballs have no index to diff against, so every file is written
+            extractSuccess = extractTarball(pack_path, staging_dir);
+        } else {
+            ZipReader reader;
+            extractSuccess = reader.open(pack_path) && reader.stage(staging_dir, gameDir);
+            if (!extractSuccess) {
+                log("Extraction failed: " + reader.error(), debug, log_file);
+            } else {
+                const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                std::stringstream ss;
+                ss << "Wrote " << reader.filesExtracted() << " files (" << std::fixed << std::setprecision(2)
+                   << (reader.bytesExtracted() / (1024.0 * 1024.0)) << " MB), linked " << reader.filesSkipped()
+                   << " unchanged in " << seconds << " s";
+                log(ss.str(), debug, log_file);
+            }
+        }
     } catch (const std::exception& e) {
         log("Exception during extraction: " + std::string(e.what()), debug, log_file);
         extractSuccess = false;
@@ -840,6 +1339,7 @@ bool downloadAndExtractPack(const std::string& pack_url, const std::string& game
 
     if (!extractSuccess) {
         log("Failed to extract pack. The archive might be corrupted.", debug, log_file);
+        removeTreeInBackground(staging_dir);
 
         // Clean up corrupted pack.zip
         try {
@@ -852,35 +1352,20 @@ bool downloadAndExtractPack(const std::string& pack_url, const std::string& game
     }
 
     // Verify extraction was successful by checking for essential directories
-    const std::vector<std::string> essentialDirs = {"mods", "config"};
-    bool allDirsExist = true;
-
-    for (const auto& dir : essentialDirs) {
-        const std::string dirPath = gameDir + dir;
-        if (!fs::exists(dirPath)) {
-            log("Essential directory missing after extraction: " + dir, debug, log_file);
-            allDirsExist = false;
-        }
-    }
-
-    if (!allDirsExist) {
+    if (!packDirectoriesPresent(staging_dir, debug, log_file)) {
         log("Pack extraction incomplete - missing essential directories.", debug, log_file);
 
         // Clean up incomplete extraction
+        removeTreeInBackground(staging_dir);
         try {
             fs::remove(pack_path);
         } catch (...) {}
         return false;
     }
 
-    // Clean up pack.zip after successful extraction
-    try {
-        fs::remove(pack_path);
-        log("Successfully extracted and cleaned up pack.zip", debug, log_file);
-    } catch (const fs::filesystem_error& e) {
-        log("Warning: Failed to remove pack.zip after extraction: " + std::string(e.what()), debug, log_file);
-        // Not critical - extraction was successful
-    }
+    // pack.zip stays on disk so the next update can revalidate it instead of downloading again
+    if (!installStagedPack(staging_dir, gameDir, debug, log_file)) return false;
+    log("Successfully extracted pack.zip", debug, log_file);
 
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include "include/mirror_registry.h"
+#include "include/http_client.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+constexpr double UNMEASURED_TTFB_MS = 1000.0;
+constexpr double DEFAULT_BYTES_PER_SECOND = 5.0 * 1024 * 1024;
+constexpr double REFERENCE_BYTES = 4.0 * 1024 * 1024;  // Score = TTFB + time to fetch this much
+constexpr double DEMOTED_PENALTY_MS = 1e9;
+constexpr size_t MIN_SAMPLES_FOR_P95 = 5;
+constexpr auto DEFAULT_HEDGE_DELAY = std::chrono::milliseconds(1500);
+constexpr auto MIN_HEDGE_DELAY = std::chrono::milliseconds(50);
+constexpr std::int64_t PROBE_INTERVAL_SECONDS = 6 * 3600;
+constexpr std::int64_t BASE_DEMOTION_SECONDS = 300;
+constexpr std::int64_t MAX_DEMOTION_SECONDS = 3600;
+
+static std::int64_t unixNow() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+MirrorRegistry& MirrorRegistry::getInstance() {
+    static MirrorRegistry instance;
+    return instance;
+}
+
+void MirrorRegistry::configure(const std::vector<MirrorGroup>& mirrorGroups, const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    groups.clear();
+    for (const auto& group : mirrorGroups) {
+        if (!group.origin.empty() && !group.mirrors.empty()) groups.push_back(group);
+    }
+    statePath = path;
+    mirrors.clear();
+    dirty = false;
+    load();
+}
+
+// Caller holds mutex
+void MirrorRegistry::load() {
+    if (statePath.empty()) return;
+    try {
+        std::ifstream ifs(statePath);
+        if (!ifs.is_open()) return;
+        json data;
+        ifs >> data;
+        if (!data.contains("mirrors") || !data["mirrors"].is_object()) return;
+
+        for (const auto& [base, entry] : data["mirrors"].items()) {
+            Mirror mirror;
+            mirror.ttfbMs = entry.value("ttfb_ms", 0.0);
+            mirror.bytesPerSecond = entry.value("bytes_per_second", 0.0);
+            mirror.failures = entry.value("failures", 0);
+            mirror.demotedUntil = entry.value("demoted_until", std::int64_t{0});
+            mirror.probedAt = entry.value("probed_at", std::int64_t{0});
+            if (entry.contains("ttfb_samples") && entry["ttfb_samples"].is_array()) {
+                for (const auto& sample : entry["ttfb_samples"]) {
+                    if (sample.is_number()) mirror.ttfbSamples.push_back(sample.get<double>());
+                }
+                while (mirror.ttfbSamples.size() > TTFB_WINDOW) mirror.ttfbSamples.pop_front();
+            }
+            mirrors[base] = std::move(mirror);
+        }
+    } catch (const json::exception& e) {
+        std::cerr << "Ignoring corrupt mirror ranking: " << e.what() << std::endl;
+        mirrors.clear();
+    }
+}
+
+void MirrorRegistry::save() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!dirty || statePath.empty()) return;
+
+    json entries = json::object();
+    for (const auto& [base, mirror] : mirrors) {
+        entries[base] = {
+            {"ttfb_ms", mirror.ttfbMs},
+            {"bytes_per_second", mirror.bytesPerSecond},
+            {"ttfb_samples", mirror.ttfbSamples},
+            {"failures", mirror.failures},
+            {"demoted_until", mirror.demotedUntil},
+            {"probed_at", mirror.probedAt}
+        };
+    }
+
+    const std::string tempPath = statePath + ".tmp";
+    try {
+        {
+            std::ofstream ofs(tempPath, std::ios::trunc);
+            if (!ofs.is_open()) return;
+            ofs << json{{"mirrors", entries}}.dump(4);
+        }
+        fs::rename(tempPath, statePath);
+        dirty = false;
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to save mirror ranking: " << e.what() << std::endl;
+    }
+}
+
+// Caller holds mutex. Lower is better; unmeasured mirrors keep their configured order.
+double MirrorRegistry::score(const std::string& base, size_t configIndex, std::int64_t now) const {
+    const auto it = mirrors.find(base);
+    const Mirror empty;
+    const Mirror& mirror = it != mirrors.end() ? it->second : empty;
+
+    double value = mirror.ttfbMs > 0.0 ? mirror.ttfbMs : UNMEASURED_TTFB_MS + static_cast<double>(configIndex);
+    const double rate = mirror.bytesPerSecond > 0.0 ? mirror.bytesPerSecond : DEFAULT_BYTES_PER_SECOND;
+    value += REFERENCE_BYTES / rate * 1000.0;
+    if (mirror.demotedUntil > now) value += DEMOTED_PENALTY_MS;
+    return value;
+}
+
+std::vector<MirrorCandidate> MirrorRegistry::candidates(const std::string& url) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const MirrorGroup* group = nullptr;
+    for (const auto& candidate : groups) {
+        if (url.compare(0, candidate.origin.size(), candidate.origin) == 0 &&
+            (!group || candidate.origin.size() > group->origin.size())) {
+            group = &candidate;
+        }
+    }
+    if (!group) return {MirrorCandidate{"", url, std::chrono::milliseconds(0)}};
+
+    const std::string path = url.substr(group->origin.size());
+    const std::int64_t now = unixNow();
+    std::vector<std::pair<double, MirrorCandidate>> ranked;
+    for (size_t i = 0; i <= group->mirrors.size(); ++i) {
+        const std::string& base = i == 0 ? group->origin : group->mirrors[i - 1];
+
+        MirrorCandidate candidate{base, base + path, DEFAULT_HEDGE_DELAY};
+        if (const auto it = mirrors.find(base); it != mirrors.end() && it->second.ttfbSamples.size() >= MIN_SAMPLES_FOR_P95) {
+            std::vector<double> samples(it->second.ttfbSamples.begin(), it->second.ttfbSamples.end());
+            const size_t index = std::min(samples.size() - 1, samples.size() * 95 / 100);
+            std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(index), samples.end());
+            candidate.hedgeAfter = std::max(MIN_HEDGE_DELAY, std::chrono::milliseconds(static_cast<long long>(samples[index])));
+        }
+        ranked.emplace_back(score(base, i, now), std::move(candidate));
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<MirrorCandidate> result;
+    for (auto& entry : ranked) result.push_back(std::move(entry.second));
+    return result;
+}
+
+// Caller holds mutex
+void MirrorRegistry::addTtfb(Mirror& mirror, double ttfbMs) {
+    mirror.ttfbSamples.push_back(ttfbMs);
+    if (mirror.ttfbSamples.size() > TTFB_WINDOW) mirror.ttfbSamples.pop_front();
+    mirror.ttfbMs = mirror.ttfbMs > 0.0 ? mirror.ttfbMs * 0.7 + ttfbMs * 0.3 : ttfbMs;
+}
+
+void MirrorRegistry::record(const std::string& base, const MirrorSample& sample) {
+    if (base.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    Mirror& mirror = mirrors[base];
+    dirty = true;
+
+    if (!sample.ok) {
+        // Dead or broken mirrors sit out for a while, longer each time they fail again
+        ++mirror.failures;
+        const int doublings = std::min(mirror.failures - 1, 8);
+        mirror.demotedUntil = unixNow() + std::min(MAX_DEMOTION_SECONDS, BASE_DEMOTION_SECONDS << doublings);
+        return;
+    }
+
+    mirror.failures = 0;
+    mirror.demotedUntil = 0;
+    if (sample.ttfbMs > 0.0) addTtfb(mirror, sample.ttfbMs);
+
+    // Small bodies say little about bandwidth
+    constexpr std::uint64_t MIN_THROUGHPUT_BYTES = 256 * 1024;
+    if (sample.bytes >= MIN_THROUGHPUT_BYTES && sample.seconds > 0.0) {
+        const double rate = static_cast<double>(sample.bytes) / sample.seconds;
+        mirror.bytesPerSecond = mirror.bytesPerSecond > 0.0 ? mirror.bytesPerSecond * 0.7 + rate * 0.3 : rate;
+    }
+}
+
+void MirrorRegistry::recordSlow(const std::string& base, double waitedMs) {
+    if (base.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    // A lower bound of its real TTFB, which is enough to push it down the ranking
+    addTtfb(mirrors[base], waitedMs);
+    dirty = true;
+}
+
+void MirrorRegistry::probe(std::chrono::milliseconds timeout) {
+    std::vector<std::string> bases;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const std::int64_t now = unixNow();
+        for (const auto& group : groups) {
+            for (size_t i = 0; i <= group.mirrors.size(); ++i) {
+                const std::string& base = i == 0 ? group.origin : group.mirrors[i - 1];
+                const auto it = mirrors.find(base);
+                if ((it == mirrors.end() || now - it->second.probedAt >= PROBE_INTERVAL_SECONDS) &&
+                    std::find(bases.begin(), bases.end(), base) == bases.end()) {
+                    bases.push_back(base);
+                }
+            }
+        }
+    }
+    if (bases.empty()) return;
+
+    CURLM* multi = curl_multi_init();
+    if (!multi) return;
+
+    // Any HTTP answer counts: the base URL itself rarely names a file. The DNS entries and
+    // TLS sessions from here stay in the shared cache for the downloads that follow.
+    std::vector<PooledCurlHandle> handles(bases.size());
+    for (size_t i = 0; i < bases.size(); ++i) {
+        CURL* curl = handles[i].get();
+        if (!curl) continue;
+        curl_easy_setopt(curl, CURLOPT_URL, bases[i].c_str());
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, static_cast<long>(timeout.count()));
+        curl_easy_setopt(curl, CURLOPT_USERAGENT, "PurrLauncher/2.4.104");
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+        curl_easy_setopt(curl, CURLOPT_PRIVATE, reinterpret_cast<char*>(i));
+        curl_multi_add_handle(multi, curl);
+    }
+
+    int running = 1;
+    while (running > 0) {
+        if (curl_multi_perform(multi, &running) != CURLM_OK) break;
+        if (running > 0) curl_multi_poll(multi, nullptr, 0, 100, nullptr);
+    }
+
+    int queued = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+        if (msg->msg != CURLMSG_DONE) continue;
+        char* privateData = nullptr;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &privateData);
+        const size_t index = reinterpret_cast<size_t>(privateData);
+
+        MirrorSample sample;
+        sample.ok = msg->data.result == CURLE_OK;
+        curl_off_t ttfb = 0;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_STARTTRANSFER_TIME_T, &ttfb);
+        sample.ttfbMs = static_cast<double>(ttfb) / 1000.0;
+        HttpClient::getInstance().recordTransfer(msg->easy_handle);
+        record(bases[index], sample);
+    }
+
+    for (auto& handle : handles) {
+        if (handle.get()) curl_multi_remove_handle(multi, handle.get());
+    }
+    curl_multi_cleanup(multi);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const std::int64_t now = unixNow();
+        for (const auto& base : bases) mirrors[base].probedAt = now;
+        dirty = true;
+    }
+    save();
+}
+
+std::vector<std::string> MirrorRegistry::describe() const {
+    std::vector<MirrorGroup> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot = groups;
+    }
+
+    std::vector<std::string> lines;
+    for (const auto& group : snapshot) {
+        const std::vector<MirrorCandidate> ranked = candidates(group.origin);
+        std::lock_guard<std::mutex> lock(mutex);
+        const std::int64_t now = unixNow();
+        for (const auto& candidate : ranked) {
+            std::ostringstream line;
+            line << group.name << ": " << candidate.base;
+            const auto it = mirrors.find(candidate.base);
+            if (it == mirrors.end() || it->second.ttfbMs <= 0.0) {
+                line << " (unmeasured)";
+            } else {
+                line << " (" << static_cast<long long>(it->second.ttfbMs) << " ms";
+                if (it->second.bytesPerSecond > 0.0) {
+                    line << ", " << std::fixed << std::setprecision(1) << (it->second.bytesPerSecond / (1024.0 * 1024.0)) << " MB/s";
+                }
+                line << ")";
+            }
+            if (it != mirrors.end() && it->second.demotedUntil > now) line << " demoted";
+            lines.push_back(line.str());
+        }
+    }
+    return lines;
+}
@@ -10,7 +10,7 @@ void DownloadMissingPlugins(const bool debug, const std::string& log_file) {
     const std::string dllUrl = "https://your-api-server.com/update";
     if (!fs::exists(dllPath)) {
         log("Updater plugin DLL missing. Downloading from " + dllUrl + "...", debug, log_file);
-        if (!downloadFile(dllUrl, dllPath)) {
+        if (!downloadFile(dllUrl, dllPath, TransferClass::Library)) {
             log("Failed to download updater plugin DLL.", debug, log_file);
         } else {
             log("Updater plugin DLL downloaded successfully.", debug, log_file);
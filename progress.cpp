@@ -0,0 +1,220 @@
+#include "include/progress.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+void TransferProgress::setExpected(std::uint64_t bytes) {
+    if (!tracker || bytes == 0 || bytes == expected) return;
+    if (expected == 0) {
+        tracker->unknownSizes.fetch_sub(1, std::memory_order_relaxed);
+        tracker->bytesExpected.fetch_add(bytes, std::memory_order_relaxed);
+    } else if (bytes > expected) {
+        tracker->bytesExpected.fetch_add(bytes - expected, std::memory_order_relaxed);
+    } else {
+        tracker->bytesExpected.fetch_sub(expected - bytes, std::memory_order_relaxed);
+    }
+    expected = bytes;
+}
+
+void TransferProgress::finish() {
+    if (!tracker) return;
+    ProgressTracker* owner = tracker;
+    tracker = nullptr;
+    owner->end(received, expected);
+}
+
+ProgressTracker& ProgressTracker::getInstance() {
+    static ProgressTracker instance;
+    return instance;
+}
+
+ProgressTracker::~ProgressTracker() {
+    shutdown();
+}
+
+void ProgressReservation::take(std::uint64_t bytes) {
+    if (!tracker) return;
+    bytes = std::min(bytes, remaining);
+    remaining -= bytes;
+    tracker->bytesExpected.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void ProgressReservation::release() {
+    if (!tracker) return;
+    take(remaining);
+    ProgressTracker* owner = tracker;
+    tracker = nullptr;
+    std::lock_guard<std::mutex> lock(owner->mutex);
+    owner->close(true);
+}
+
+// Caller holds mutex
+void ProgressTracker::open() {
+    if (active == 0) {
+        // First transfer of a new session: the bar starts from zero
+        std::lock_guard<std::mutex> drawLock(drawMutex);
+        bytesReceived.store(0, std::memory_order_relaxed);
+        bytesExpected.store(0, std::memory_order_relaxed);
+        unknownSizes.store(0, std::memory_order_relaxed);
+        sessionOpen = true;
+        framesDrawn = 0;
+        rate = 0.0;
+        lastSampleBytes = 0;
+        sessionStart = lastSample = std::chrono::steady_clock::now();
+    }
+    ++active;
+
+    if (!renderer.joinable() && !quit) {
+        renderer = std::thread(&ProgressTracker::renderLoop, this);
+    }
+    wake.notify_all();
+}
+
+// Caller holds mutex
+void ProgressTracker::close(bool reservation) {
+    if (reservation) --reserved;
+    if (--active > 0) return;
+
+    // Close the bar here rather than on the render thread, so output that follows
+    // the transfer starts on a fresh line
+    draw(true, 0, label);
+}
+
+TransferProgress ProgressTracker::begin(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    open();
+    label = name;
+    unknownSizes.fetch_add(1, std::memory_order_relaxed);
+    return TransferProgress(this);
+}
+
+ProgressReservation ProgressTracker::reserve(std::uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    open();
+    ++reserved;
+    bytesExpected.fetch_add(bytes, std::memory_order_relaxed);
+    return ProgressReservation(this, bytes);
+}
+
+void ProgressTracker::end(std::uint64_t received, std::uint64_t expected) {
+    // A finished transfer is complete by definition: what it never received leaves the
+    // total, and a size that was never announced becomes what actually arrived
+    if (expected == 0) {
+        unknownSizes.fetch_sub(1, std::memory_order_relaxed);
+        bytesExpected.fetch_add(received, std::memory_order_relaxed);
+    } else if (expected > received) {
+        bytesExpected.fetch_sub(expected - received, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    close(false);
+}
+
+void ProgressTracker::renderLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!quit) {
+        if (active == 0) {
+            wake.wait(lock, [this] { return quit || active > 0; });
+            continue;
+        }
+        wake.wait_for(lock, FRAME_INTERVAL, [this] { return quit; });
+        if (quit || active == 0) continue;
+
+        const size_t activeTransfers = active - reserved;
+        const std::string currentLabel = label;
+        lock.unlock();
+        draw(false, activeTransfers, currentLabel);
+        lock.lock();
+    }
+}
+
+static void appendSize(std::ostringstream& out, double bytes) {
+    out << std::fixed << std::setprecision(1) << (bytes / (1024.0 * 1024.0));
+}
+
+void ProgressTracker::draw(bool final, size_t activeTransfers, const std::string& currentLabel) {
+    std::lock_guard<std::mutex> lock(drawMutex);
+    if (!sessionOpen) return;
+    if (final) {
+        sessionOpen = false;
+        if (framesDrawn == 0) return;  // Too short to have shown a bar; nothing to close
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const std::uint64_t received = bytesReceived.load(std::memory_order_relaxed);
+    const std::uint64_t expected = bytesExpected.load(std::memory_order_relaxed);
+    const bool sizeKnown = unknownSizes.load(std::memory_order_relaxed) == 0 && expected > 0;
+
+    if (final) {
+        const double elapsed = std::chrono::duration<double>(now - sessionStart).count();
+        rate = elapsed > 0.0 ? static_cast<double>(received) / elapsed : 0.0;
+    } else {
+        const double elapsed = std::chrono::duration<double>(now - lastSample).count();
+        const double delta = received > lastSampleBytes ? static_cast<double>(received - lastSampleBytes) : 0.0;
+        if (elapsed > 0.0) {
+            const double instant = delta / elapsed;
+            rate = framesDrawn == 0 ? instant : rate * 0.7 + instant * 0.3;
+        }
+    }
+    lastSample = now;
+    lastSampleBytes = received;
+
+    std::ostringstream line;
+    line << "\r";
+    if (sizeKnown) {
+        constexpr int BAR_WIDTH = 40;
+        const double fraction = std::min(1.0, static_cast<double>(received) / static_cast<double>(expected));
+        const int filled = static_cast<int>(fraction * BAR_WIDTH);
+        line << "[" << std::string(filled, '=') << std::string(BAR_WIDTH - filled, ' ') << "] "
+             << static_cast<int>(fraction * 100) << "% ";
+        appendSize(line, static_cast<double>(received));
+        line << "/";
+        appendSize(line, static_cast<double>(expected));
+        line << " MB";
+    } else {
+        const char spinner[] = {'|', '/', '-', '\\'};
+        spinnerIndex = (spinnerIndex + 1) % 4;
+        line << "[" << (final ? '=' : spinner[spinnerIndex]) << "] ";
+        appendSize(line, static_cast<double>(received));
+        line << " MB";
+    }
+
+    if (rate >= 1024.0 * 1024.0) {
+        line << " (" << std::fixed << std::setprecision(2) << (rate / (1024.0 * 1024.0)) << " MB/s";
+    } else {
+        line << " (" << std::fixed << std::setprecision(1) << (rate / 1024.0) << " KB/s";
+    }
+    if (!final && sizeKnown && rate > 0.0 && expected > received) {
+        const double etaSeconds = static_cast<double>(expected - received) / rate;
+        if (etaSeconds < 3600) {
+            line << ", ETA: " << static_cast<int>(etaSeconds / 60) << "m " << static_cast<int>(etaSeconds) % 60 << "s";
+        }
+    }
+    line << ")";
+
+    if (activeTransfers == 1) {
+        line << " " << currentLabel;
+    } else if (activeTransfers > 1) {
+        line << " " << activeTransfers << " active";
+    }
+
+    // Pad over the remains of a longer previous frame
+    std::string text = line.str();
+    const size_t length = text.size();
+    if (length < lastLineLength) text.append(lastLineLength - length, ' ');
+    lastLineLength = final ? 0 : length;
+    if (final) text += "\n";
+
+    std::cout << text << std::flush;
+    ++framesDrawn;
+}
+
+void ProgressTracker::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    if (renderer.joinable()) renderer.join();
+}
@@ -0,0 +1,98 @@
+#include "include/retry_policy.h"
+#include <algorithm>
+#include <random>
+
+AttemptFailure AttemptFailure::fromTransfer(CURL* curl, CURLcode result) {
+    AttemptFailure failure;
+    failure.curlCode = result;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &failure.httpStatus);
+
+    // Only meaningful on the statuses that define it; curl parses both the seconds and the date form
+    if (failure.httpStatus == 429 || failure.httpStatus == 503) {
+        curl_off_t seconds = 0;
+        if (curl_easy_getinfo(curl, CURLINFO_RETRY_AFTER, &seconds) == CURLE_OK && seconds > 0) {
+            failure.retryAfter = std::chrono::seconds(seconds);
+        }
+    }
+    return failure;
+}
+
+bool AttemptFailure::permanent() const {
+    if (httpStatus >= 400 && httpStatus < 500) {
+        return httpStatus != 408 && httpStatus != 425 && httpStatus != 429;
+    }
+
+    switch (curlCode) {
+        case CURLE_UNSUPPORTED_PROTOCOL:
+        case CURLE_URL_MALFORMAT:
+        case CURLE_NOT_BUILT_IN:
+        case CURLE_TOO_MANY_REDIRECTS:
+        case CURLE_PEER_FAILED_VERIFICATION:
+        case CURLE_SSL_CERTPROBLEM:
+        case CURLE_SSL_CACERT_BADFILE:
+        case CURLE_LOGIN_DENIED:
+        case CURLE_REMOTE_ACCESS_DENIED:
+        case CURLE_FILESIZE_EXCEEDED:
+            return true;
+        default:
+            return false;
+    }
+}
+
+RetryPolicy RetryPolicy::download() {
+    return RetryPolicy{};
+}
+
+RetryPolicy RetryPolicy::api() {
+    RetryPolicy policy;
+    policy.baseDelay = std::chrono::milliseconds(500);
+    policy.maxDelay = std::chrono::milliseconds(8000);
+    policy.deadline = std::chrono::milliseconds(60000);
+    return policy;
+}
+
+const char* retryDecisionText(RetryDecision decision) {
+    switch (decision) {
+        case RetryDecision::Retry: return "retrying";
+        case RetryDecision::Permanent: return "permanent error";
+        case RetryDecision::OutOfAttempts: return "out of attempts";
+        case RetryDecision::PastDeadline: return "deadline reached";
+    }
+    return "unknown";
+}
+
+// Uniform in [low, high]
+static std::chrono::milliseconds jitter(std::chrono::milliseconds low, std::chrono::milliseconds high) {
+    thread_local std::mt19937_64 generator{std::random_device{}()};
+    if (high <= low) return low;
+    std::uniform_int_distribution<long long> distribution(low.count(), high.count());
+    return std::chrono::milliseconds(distribution(generator));
+}
+
+RetryState::RetryState(const RetryPolicy& retryPolicy)
+    : policy(retryPolicy), started(std::chrono::steady_clock::now()) {
+    policy.maxAttempts = std::max(policy.maxAttempts, 1);
+}
+
+std::chrono::milliseconds RetryState::remaining() const {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    return std::max(policy.deadline - elapsed, std::chrono::milliseconds(0));
+}
+
+RetryDecision RetryState::next(const AttemptFailure& failure, std::chrono::milliseconds& delay) {
+    if (failure.permanent()) return RetryDecision::Permanent;
+    if (attemptNumber >= policy.maxAttempts) return RetryDecision::OutOfAttempts;
+
+    if (failure.retryAfter.count() >= 0) {
+        // Everyone who was told to come back in N seconds would otherwise return in the same instant
+        delay = failure.retryAfter + jitter(std::chrono::milliseconds(0), failure.retryAfter / 4);
+    } else {
+        const int doublings = std::min(attemptNumber - 1, 20);
+        const auto ceiling = std::min<std::chrono::milliseconds>(policy.maxDelay, policy.baseDelay * (1LL << doublings));
+        delay = jitter(std::chrono::milliseconds(0), ceiling);
+    }
+
+    if (delay >= remaining()) return RetryDecision::PastDeadline;
+    ++attemptNumber;
+    return RetryDecision::Retry;
+}